@@ -1,5 +1,7 @@
 #pragma once
 
+#include <iostream>
+
 #include <franka/duration.h>
 #include <franka/robot_state.h>
 
@@ -43,6 +45,7 @@ struct JointMotionGenerator: public MotionGenerator {
 
         input_para.max_velocity *= robot->velocity_rel * data.velocity_rel;
         input_para.max_acceleration *= robot->acceleration_rel * data.acceleration_rel;
+        input_para.mark_changed();
     }
 
     franka::JointPositions operator()(const franka::RobotState& robot_state, franka::Duration period) {
@@ -66,14 +69,12 @@ struct JointMotionGenerator: public MotionGenerator {
                 Eigen::VectorXd::Map(&joint_positions[0], 7) = input_para.target_position;
                 return franka::MotionFinished(franka::JointPositions(joint_positions));
 
-            } else if (result == movex::Result::Error) {
+            } else if (movex::is_error(result)) {
                 std::cout << "[frankx robot] Invalid inputs:" << std::endl;
                 return franka::MotionFinished(franka::JointPositions(joint_positions));
             }
 
-            input_para.current_position = output_para.new_position;
-            input_para.current_velocity = output_para.new_velocity;
-            input_para.current_acceleration = output_para.new_acceleration;
+            output_para.pass_to_input(input_para);
         }
 
         return franka::JointPositions(joint_positions);
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <iostream>
+
 #include <franka/duration.h>
 #include <franka/robot_state.h>
 
@@ -29,6 +31,13 @@ struct WaypointMotionGenerator: public MotionGenerator {
     movex::OutputParameter<RobotType::degrees_of_freedoms> output_para;
     movex::Result result;
 
+    // Time-optimal braking of each DoF for stop reactions, calculated in closed form within the same cycle
+    movex::Ruckig<RobotType::degrees_of_freedoms> stop_generator {RobotType::control_rate};
+    movex::InputParameter<RobotType::degrees_of_freedoms> stop_input;
+    movex::RuckigTrajectory<RobotType::degrees_of_freedoms> stop_trajectory;
+    double stop_time {0.0};
+    bool is_stopping {false};
+
     WaypointMotion current_motion;
     std::vector<Waypoint>::iterator waypoint_iterator;
     bool waypoint_has_elbow {false};
@@ -50,7 +59,11 @@ struct WaypointMotionGenerator: public MotionGenerator {
     }
 
     void init(const franka::RobotState& robot_state, franka::Duration period) {
+        is_stopping = false;
         input_para.enabled = MotionGenerator::VectorCartRotElbow(true, true, true);
+#ifdef WITH_REFLEXXES
+        input_para.synchronization = movex::InputParameter<RobotType::degrees_of_freedoms>::Synchronization::Phase; // Reflexxes phase-synchronizes if possible, as before the option existed
+#endif
         setInputLimits(input_para, robot, data);
 
         waypoint_iterator = current_motion.waypoints.begin();
@@ -77,6 +90,7 @@ struct WaypointMotionGenerator: public MotionGenerator {
         input_para.target_position = target_position_vector;
         input_para.target_velocity = Vector7d::Zero();
         setInputLimits(input_para, robot, current_waypoint, data);
+        input_para.mark_changed();
 
         old_affine = current_waypoint.getTargetAffine(frame, old_affine);
         old_vector = target_position_vector;
@@ -110,7 +124,20 @@ struct WaypointMotionGenerator: public MotionGenerator {
                     robot->stop();
                 }
 
-                if (new_motion) {
+                if (new_motion && current_motion.stop) {
+                    // Brake from the current state of the trajectory generator with the maximal dynamics, so that the stop is continuous and short
+                    Waypoint max_dynamics_waypoint;
+                    max_dynamics_waypoint.max_dynamics = true;
+                    stop_input = input_para;
+                    setInputLimits(stop_input, robot, max_dynamics_waypoint, data);
+                    if (movex::is_error(stop_generator.calculate_stop(stop_input, stop_trajectory))) {
+                        std::cout << "[frankx robot] Invalid inputs for stopping:" << std::endl;
+                        return franka::MotionFinished(MotionGenerator::CartesianPose(input_para.current_position, waypoint_has_elbow));
+                    }
+                    stop_time = 0.0;
+                    is_stopping = true;
+
+                } else if (new_motion) {
                     waypoint_iterator = current_motion.waypoints.begin();
 
                     franka::CartesianPose current_cartesian_pose(robot_state.O_T_EE_c, robot_state.elbow_c);
@@ -128,6 +155,7 @@ struct WaypointMotionGenerator: public MotionGenerator {
                     input_para.target_position = target_position_vector;
                     input_para.target_velocity = Vector7d::Zero();
                     setInputLimits(input_para, robot, current_waypoint, data);
+                    input_para.mark_changed();
 
                     old_affine = current_waypoint.getTargetAffine(Affine(), old_affine);
                     old_vector = target_position_vector;
@@ -146,6 +174,15 @@ struct WaypointMotionGenerator: public MotionGenerator {
 
         const int steps = std::max<int>(period.toMSec(), 1);
         for (int i = 0; i < steps; i++) {
+            if (is_stopping) {
+                stop_time += stop_generator.delta_time;
+                stop_trajectory.at_time(stop_time, output_para.new_position, output_para.new_velocity, output_para.new_acceleration);
+                if (stop_time >= stop_trajectory.get_duration()) {
+                    return franka::MotionFinished(MotionGenerator::CartesianPose(output_para.new_position, waypoint_has_elbow));
+                }
+                continue;
+            }
+
             result = trajectory_generator.update(input_para, output_para);
 
             if (motion.reload || result == movex::Result::Finished) {
@@ -176,20 +213,19 @@ struct WaypointMotionGenerator: public MotionGenerator {
                     input_para.target_position = target_position_vector;
                     input_para.target_velocity = Vector7d::Zero();
                     setInputLimits<RobotType>(input_para, robot, current_waypoint, data);
+                    input_para.mark_changed();
 
                     old_affine = current_waypoint.getTargetAffine(frame, old_affine);
                     old_vector = target_position_vector;
                     old_elbow = old_vector(6);
                 }
 
-            } else if (result == movex::Result::Error) {
+            } else if (movex::is_error(result)) {
                 std::cout << "[frankx robot] Invalid inputs:" << std::endl;
                 return franka::MotionFinished(MotionGenerator::CartesianPose(input_para.current_position, waypoint_has_elbow));
             }
 
-            input_para.current_position = output_para.new_position;
-            input_para.current_velocity = output_para.new_velocity;
-            input_para.current_acceleration = output_para.new_acceleration;
+            output_para.pass_to_input(input_para);
         }
 
         return MotionGenerator::CartesianPose(output_para.new_position, waypoint_has_elbow);
@@ -17,6 +17,9 @@ struct WaypointMotion {
     bool reload {false};
     bool return_when_finished {true};
 
+    //! Brake time-optimally from the current state instead of following the waypoints
+    bool stop {false};
+
     std::vector<Waypoint> waypoints;
 
     explicit WaypointMotion() {}
@@ -54,7 +57,9 @@ struct LinearRelativeMotion: public WaypointMotion {
 
 
 struct StopMotion: public WaypointMotion {
-    explicit StopMotion(): WaypointMotion({ Waypoint(Affine(), 0.0, Waypoint::ReferenceType::Relative, true) }) { }
+    explicit StopMotion(): WaypointMotion({ Waypoint(Affine(), 0.0, Waypoint::ReferenceType::Relative, true) }) {
+        stop = true;
+    }
     explicit StopMotion(const Affine& affine): WaypointMotion({ Waypoint(affine, Waypoint::ReferenceType::Relative, true) }) { }
     explicit StopMotion(const Affine& affine, double elbow): WaypointMotion({ Waypoint(affine, elbow, Waypoint::ReferenceType::Relative, true) }) { }
 };
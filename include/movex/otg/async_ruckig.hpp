@@ -0,0 +1,233 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <optional>
+#include <thread>
+
+#include <semaphore.h>
+
+#include <movex/otg/parameter.hpp>
+#include <movex/otg/ruckig.hpp>
+
+
+namespace movex {
+
+/**
+ * Wait-free handoff of values from a single writer to a single reader thread.
+ * The writer and reader each own one buffer, and exchange it atomically with the third (middle) one.
+ */
+template<class T>
+class TripleBuffer {
+    static constexpr uint8_t index_mask {0b011};
+    static constexpr uint8_t fresh_bit {0b100};
+
+    std::array<T, 3> buffers;
+    std::atomic<uint8_t> middle {1};
+    uint8_t front {0}, back {2};
+
+public:
+    //! Buffer of the writer, which can be modified until publish() is called
+    T& write_buffer() {
+        return buffers[back];
+    }
+
+    //! Hand the write buffer over to the reader
+    void publish() {
+        back = middle.exchange(back | fresh_bit) & index_mask;
+    }
+
+    //! Whether a value was published since the last fetch()
+    bool has_fresh() const {
+        return middle.load() & fresh_bit;
+    }
+
+    //! Take the latest published value as read buffer. Returns false if there is none.
+    bool fetch() {
+        if (!has_fresh()) {
+            return false;
+        }
+
+        front = middle.exchange(front) & index_mask;
+        return true;
+    }
+
+    //! Buffer of the reader, which is valid until the next fetch()
+    const T& read_buffer() const {
+        return buffers[front];
+    }
+};
+
+
+/**
+ * Counting semaphore to wake up a thread, as std::counting_semaphore needs C++20. Releasing never blocks or locks
+ * (it is a futex on Linux), so that a real-time thread can wake up another one.
+ */
+class Semaphore {
+    sem_t semaphore;
+
+public:
+    Semaphore() {
+        sem_init(&semaphore, 0, 0);
+    }
+
+    ~Semaphore() {
+        sem_destroy(&semaphore);
+    }
+
+    Semaphore(const Semaphore&) = delete;
+    Semaphore& operator=(const Semaphore&) = delete;
+
+    void release() {
+        sem_post(&semaphore);
+    }
+
+    //! Wait until the semaphore is released, and decrement it
+    void acquire() {
+        while (sem_wait(&semaphore) != 0 && errno == EINTR) { }
+    }
+};
+
+
+/**
+ * Calculates Ruckig trajectories in a companion worker thread, e.g. the trajectory to the next waypoint ahead of time.
+ * Switching trajectories is wait-free, and requesting one is lock-free and never waits for the worker,
+ * so the real-time thread is independent of the calculation time.
+ */
+template<size_t DOFs>
+class AsyncRuckig {
+    struct Calculation {
+        RuckigTrajectory<DOFs> trajectory;
+        InputParameter<DOFs> input;
+        double calculation_duration {-1};
+    };
+
+    //! Only used by the worker thread
+    Ruckig<DOFs> otg;
+
+    TripleBuffer<InputParameter<DOFs>> requests;
+    TripleBuffer<Calculation> calculations;
+
+    std::atomic<Result> last_result {Result::Working};
+    std::atomic<bool> stop {false};
+    std::atomic<bool> is_woken {false}; // Whether the worker is already woken up for the pending request, so that it is released once
+    Semaphore wakeup;
+    std::thread worker;
+
+    //! State of the real-time thread
+    const Calculation* current {nullptr};
+    std::optional<typename RuckigTrajectory<DOFs>::Cursor> cursor;
+    double t {0.0};
+
+    void work() {
+        while (true) {
+            wakeup.acquire();
+            is_woken = false; // Requests published from now on release the worker again
+
+            if (stop) {
+                return;
+            }
+
+            // A request might have been fetched already after an earlier release
+            if (!requests.fetch()) {
+                continue;
+            }
+
+            // A failed calculation isn't published, so that the real-time thread keeps its current trajectory
+            auto& calculation = calculations.write_buffer();
+            calculation.input = requests.read_buffer();
+            const Result result = otg.calculate(calculation.input, calculation.trajectory);
+            last_result = result;
+            if (result == Result::Working) {
+                calculation.calculation_duration = otg.last_calculation_duration;
+                calculations.publish();
+            }
+        }
+    }
+
+public:
+    //! Time step between updates (cycle time) in [s]
+    const double delta_time;
+
+    explicit AsyncRuckig(double delta_time): otg(delta_time), delta_time(delta_time) {
+        worker = std::thread(&AsyncRuckig::work, this);
+    }
+
+    ~AsyncRuckig() {
+        stop = true;
+        wakeup.release();
+        worker.join();
+    }
+
+    AsyncRuckig(const AsyncRuckig&) = delete;
+    AsyncRuckig& operator=(const AsyncRuckig&) = delete;
+
+    /**
+     * Request a trajectory for the given input from the worker thread. Previous requests that were not started yet are dropped.
+     * The current state of the input needs to be the state that update() will output when switching to the trajectory, e.g. the
+     * target of the current trajectory when switching after it finished. Otherwise, the output jumps at the switch.
+     */
+    void request(const InputParameter<DOFs>& input) {
+        requests.write_buffer() = input;
+        requests.publish();
+        if (!is_woken.exchange(true)) {
+            wakeup.release();
+        }
+    }
+
+    //! Result of the latest finished calculation. If it failed, there is no new trajectory to switch to and update() keeps the current one.
+    Result get_last_result() const {
+        return last_result;
+    }
+
+    //! Whether a calculated trajectory is available to switch to
+    bool is_ready() const {
+        return calculations.has_fresh();
+    }
+
+    //! Switch to the latest calculated trajectory and start it from the beginning. Returns false if there is no new trajectory.
+    bool switch_trajectory() {
+        if (!calculations.fetch()) {
+            return false;
+        }
+
+        current = &calculations.read_buffer();
+        cursor.emplace(current->trajectory);
+        t = 0.0;
+        return true;
+    }
+
+    //! Output the state of the current trajectory and advance by delta_time
+    Result update(OutputParameter<DOFs>& output) {
+        if (!current) {
+            return Result::Error;
+        }
+
+        output.duration = current->trajectory.get_duration();
+        if (t + delta_time > current->trajectory.get_duration() && current->input.type == InputParameter<DOFs>::Type::Position) {
+            output.new_position = current->input.target_position;
+            output.new_velocity = current->input.target_velocity;
+            output.new_acceleration = current->input.target_acceleration;
+            t += delta_time;
+            return Result::Finished;
+        }
+
+        cursor->at_time(current->trajectory, t, output.new_position, output.new_velocity, output.new_acceleration);
+        t += delta_time;
+        return (t > current->trajectory.get_duration()) ? Result::Finished : Result::Working;
+    }
+
+    //! Trajectory that is currently followed by update(), if any
+    const RuckigTrajectory<DOFs>* get_trajectory() const {
+        return current ? &current->trajectory : nullptr;
+    }
+
+    //! Time for calculating the current trajectory in the worker thread in [µs]
+    double last_calculation_duration() const {
+        return current ? current->calculation_duration : -1;
+    }
+};
+
+} // namespace movex
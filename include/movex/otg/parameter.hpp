@@ -1,6 +1,13 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
 #include <optional>
+#include <type_traits>
+#include <vector>
 
 #include <Eigen/Core>
 
@@ -10,43 +17,203 @@ namespace movex {
 enum class Result {
     Working,
     Finished,
-    Error
+    Error,
+    ErrorInvalidInput, ///< E.g. non-positive limits or targets exceeding them
+    ErrorExecutionTimeCalculation, ///< No time-optimal profile was found for a DoF (Step 1)
+    ErrorSynchronizationCalculation, ///< No profile was found for a DoF with the synchronized duration (Step 2)
+    ErrorCalculationTimeout, ///< The calculation exceeded its computation budget
 };
 
+//! Whether the result is any of the errors
+inline bool is_error(Result result) {
+    return result >= Result::Error;
+}
 
+//! Eigen vector with DOFs elements, or with a number of elements set at runtime for DOFs = 0
 template<size_t DOFs>
-struct InputParameter {
-    using Vector = Eigen::Matrix<double, DOFs, 1, Eigen::ColMajor>;
+using EigenVector = Eigen::Matrix<double, (DOFs >= 1) ? static_cast<int>(DOFs) : Eigen::Dynamic, 1, Eigen::ColMajor>;
+
+//! Array with DOFs elements, or a vector with a number of elements set at runtime for DOFs = 0
+template<class T, size_t DOFs>
+using StandardVector = std::conditional_t<(DOFs >= 1), std::array<T, DOFs>, std::vector<T>>;
+
+//! Number of DoFs as compile-time constant, or set at runtime for DOFs = 0. Generic code uses get_degrees_of_freedom() for both.
+template<size_t DOFs>
+struct DegreesOfFreedom {
     static constexpr size_t degrees_of_freedom {DOFs};
 
+    constexpr size_t get_degrees_of_freedom() const {
+        return DOFs;
+    }
+};
+
+template<>
+struct DegreesOfFreedom<0> {
+    size_t degrees_of_freedom;
+
+    size_t get_degrees_of_freedom() const {
+        return degrees_of_freedom;
+    }
+};
+
+
+/**
+ * Input of the trajectory generators. For DOFs = 0, the number of DoFs is set at runtime and all vectors
+ * are allocated once at construction.
+ */
+template<size_t DOFs>
+struct InputParameter: public DegreesOfFreedom<DOFs> {
+    using Vector = EigenVector<DOFs>;
+    using DegreesOfFreedom<DOFs>::degrees_of_freedom;
+    using DegreesOfFreedom<DOFs>::get_degrees_of_freedom;
+
     enum class Type {
         Position,
         Velocity,
     };
 
+    enum class Synchronization {
+        Time, ///< All DoFs reach the target at the same time
+        Phase, ///< Additionally, all DoFs move on a straight line if possible, otherwise fall back to time synchronization
+        None, ///< Each DoF reaches its target independently as fast as possible, e.g. for stopping
+    };
+
+    enum class DurationDiscretization {
+        Continuous, ///< The time-optimal duration, so that the last control cycle might end at the target within the cycle
+        Discrete, ///< The duration is rounded up to a multiple of the control cycle, so that the last cycle ends exactly at the target
+    };
+
     Vector current_position;
-    Vector current_velocity {Vector::Zero()};
-    Vector current_acceleration {Vector::Zero()};
+    Vector current_velocity;
+    Vector current_acceleration;
 
     Vector target_position;
-    Vector target_velocity {Vector::Zero()};
-    Vector target_acceleration {Vector::Zero()};
+    Vector target_velocity;
+
+    //! Only supported by the velocity interface of Ruckig, which reaches it time-optimally. Its position interface needs zero.
+    Vector target_acceleration;
 
     Vector max_velocity;
     Vector max_acceleration;
     Vector max_jerk;
 
-    std::array<bool, DOFs> enabled;
+    StandardVector<bool, DOFs> enabled;
     std::optional<double> minimum_duration;
     Type type {Type::Position};
+    Synchronization synchronization {Synchronization::Time};
+    DurationDiscretization duration_discretization {DurationDiscretization::Continuous};
 
+    template<size_t D = DOFs, std::enable_if_t<(D >= 1), int> = 0>
     InputParameter() {
-        enabled.fill(true);
+        initialize();
+    }
+
+    template<size_t D = DOFs, std::enable_if_t<(D == 0), int> = 0>
+    explicit InputParameter(size_t degrees_of_freedom): DegreesOfFreedom<DOFs> {degrees_of_freedom} {
+        initialize();
+    }
+
+    /**
+     * Mark the input as changed, e.g. after modifying its fields directly. Afterwards, the input is tracked
+     * and generators detect changes by its version and its current state only, without comparing the targets
+     * and limits. Then, all changes except to the current state need to be done via setters or marked as changed.
+     * Unmarked direct writes to other fields of a tracked input are not supported and fail an assertion in debug builds.
+     */
+    void mark_changed() {
+        version = ++version_counter;
+    }
+
+    uint64_t get_version() const {
+        return version;
+    }
+
+    //! Whether the input needs a new calculation compared to the last input of a generator. Generators keep the current state of their
+    //! last input at their last output, so that feeding back the output (see OutputParameter::pass_to_input) isn't a change.
+    bool has_changed(const InputParameter<DOFs>& last) const {
+        if (version != 0) {
+            assert(version != last.version || !has_untracked_change(last));
+            return version != last.version || has_current_state_changed(last);
+        }
+        return *this != last;
+    }
+
+    void set_current_state(const Vector& position, const Vector& velocity, const Vector& acceleration) {
+        current_position = position;
+        current_velocity = velocity;
+        current_acceleration = acceleration;
+        mark_changed();
+    }
+
+    void set_target_state(const Vector& position, const Vector& velocity, const Vector& acceleration) {
+        target_position = position;
+        target_velocity = velocity;
+        target_acceleration = acceleration;
+        mark_changed();
+    }
+
+    void set_target_position(const Vector& position) {
+        target_position = position;
+        mark_changed();
+    }
+
+    void set_target_velocity(const Vector& velocity) {
+        target_velocity = velocity;
+        mark_changed();
+    }
+
+    void set_target_acceleration(const Vector& acceleration) {
+        target_acceleration = acceleration;
+        mark_changed();
+    }
+
+    void set_limits(const Vector& velocity, const Vector& acceleration, const Vector& jerk) {
+        max_velocity = velocity;
+        max_acceleration = acceleration;
+        max_jerk = jerk;
+        mark_changed();
+    }
+
+    void set_enabled(const StandardVector<bool, DOFs>& new_enabled) {
+        enabled = new_enabled;
+        mark_changed();
+    }
+
+    void set_minimum_duration(const std::optional<double>& duration) {
+        minimum_duration = duration;
+        mark_changed();
+    }
+
+    void set_type(Type new_type) {
+        type = new_type;
+        mark_changed();
+    }
+
+    void set_synchronization(Synchronization new_synchronization) {
+        synchronization = new_synchronization;
+        mark_changed();
+    }
+
+    void set_duration_discretization(DurationDiscretization new_duration_discretization) {
+        duration_discretization = new_duration_discretization;
+        mark_changed();
+    }
+
+    /**
+     * Stop all DoFs time-optimally from the current state, i.e. reach zero velocity and acceleration with the velocity interface. By default,
+     * each DoF stops independently. With Phase, a collinear motion (e.g. a straight Cartesian line) keeps its path while stopping.
+     */
+    void set_stop(Synchronization stop_synchronization = Synchronization::None) {
+        type = Type::Velocity;
+        target_velocity.setZero();
+        target_acceleration.setZero();
+        synchronization = stop_synchronization;
+        mark_changed();
     }
 
     bool operator!=(const InputParameter<DOFs>& rhs) const {
         return (
-            current_position != rhs.current_position
+            get_degrees_of_freedom() != rhs.get_degrees_of_freedom()
+            || current_position != rhs.current_position
             || current_velocity != rhs.current_velocity
             || current_acceleration != rhs.current_acceleration
             || target_position != rhs.target_position
@@ -58,20 +225,85 @@ struct InputParameter {
             || enabled != rhs.enabled
             || minimum_duration != rhs.minimum_duration
             || type != rhs.type
+            || synchronization != rhs.synchronization
+            || duration_discretization != rhs.duration_discretization
         );
     }
+
+private:
+    //! Whether the current state differs, which can be written directly also for tracked inputs
+    bool has_current_state_changed(const InputParameter<DOFs>& last) const {
+        return (
+            current_position != last.current_position
+            || current_velocity != last.current_velocity
+            || current_acceleration != last.current_acceleration
+        );
+    }
+
+    //! Whether a field other than the current state differs, i.e. was written directly without marking the input as changed
+    bool has_untracked_change(const InputParameter<DOFs>& last) const {
+        return (
+            target_position != last.target_position
+            || target_velocity != last.target_velocity
+            || target_acceleration != last.target_acceleration
+            || max_velocity != last.max_velocity
+            || max_acceleration != last.max_acceleration
+            || max_jerk != last.max_jerk
+            || enabled != last.enabled
+            || minimum_duration != last.minimum_duration
+            || type != last.type
+            || synchronization != last.synchronization
+            || duration_discretization != last.duration_discretization
+        );
+    }
+
+    void initialize() {
+        current_position.resize(degrees_of_freedom);
+        current_velocity.setZero(degrees_of_freedom);
+        current_acceleration.setZero(degrees_of_freedom);
+        target_position.resize(degrees_of_freedom);
+        target_velocity.setZero(degrees_of_freedom);
+        target_acceleration.setZero(degrees_of_freedom);
+        max_velocity.resize(degrees_of_freedom);
+        max_acceleration.resize(degrees_of_freedom);
+        max_jerk.resize(degrees_of_freedom);
+
+        if constexpr (DOFs == 0) {
+            enabled.resize(degrees_of_freedom);
+        }
+        std::fill(enabled.begin(), enabled.end(), true);
+    }
+
+    //! Source of unique versions for all inputs with the same DoFs
+    inline static std::atomic<uint64_t> version_counter {0};
+
+    //! Zero if the input is untracked, otherwise the version of the last change via a setter or mark_changed()
+    uint64_t version {0};
 };
 
 
 template<size_t DOFs>
 struct OutputParameter {
-    using Vector = Eigen::Matrix<double, DOFs, 1>;
+    using Vector = EigenVector<DOFs>;
 
     Vector new_position;
     Vector new_velocity;
     Vector new_acceleration;
 
     double duration;
+
+    template<size_t D = DOFs, std::enable_if_t<(D >= 1), int> = 0>
+    OutputParameter() { }
+
+    template<size_t D = DOFs, std::enable_if_t<(D == 0), int> = 0>
+    explicit OutputParameter(size_t degrees_of_freedom): new_position(degrees_of_freedom), new_velocity(degrees_of_freedom), new_acceleration(degrees_of_freedom) { }
+
+    //! Feed the new state back as current state of the input, which the generator doesn't detect as change
+    void pass_to_input(InputParameter<DOFs>& input) const {
+        input.current_position = new_position;
+        input.current_velocity = new_velocity;
+        input.current_acceleration = new_acceleration;
+    }
 };
 
 } // namespace movex
@@ -9,7 +9,7 @@ namespace movex {
 
 template<size_t DOFs>
 class Quintic {
-    using Vector = Eigen::Matrix<double, DOFs, 1, Eigen::ColMajor>;
+    using Vector = EigenVector<DOFs>;
 
     // Trajectory
     Vector a, b, c, d, e, f;
@@ -57,32 +57,54 @@ class Quintic {
     }
 
 public:
+    const size_t degrees_of_freedom;
     double delta_time;
 
-    explicit Quintic(double delta_time): delta_time(delta_time) { }
+    template<size_t D = DOFs, std::enable_if_t<(D >= 1), int> = 0>
+    explicit Quintic(double delta_time): degrees_of_freedom(DOFs), delta_time(delta_time) { }
+
+    template<size_t D = DOFs, std::enable_if_t<(D == 0), int> = 0>
+    explicit Quintic(size_t degrees_of_freedom, double delta_time): a(degrees_of_freedom), b(degrees_of_freedom), c(degrees_of_freedom), d(degrees_of_freedom), e(degrees_of_freedom), f(degrees_of_freedom), current_input(degrees_of_freedom), degrees_of_freedom(degrees_of_freedom), delta_time(delta_time) { }
 
     Result update(const InputParameter<DOFs>& input, OutputParameter<DOFs>& output) {
         t += delta_time;
 
-        if (input != current_input && !calculate(input, output)) {
+        if (input.has_changed(current_input) && !calculate(input, output)) {
             return Result::Error;
         }
 
-        if (t >= tf) {
+        const bool is_finished = (t >= tf);
+        if (is_finished) {
             output.new_position = input.target_position;
             output.new_velocity = input.target_velocity;
             output.new_acceleration = input.target_acceleration;
-            return Result::Finished;
+        } else {
+            output.new_position = f + t * (e + t * (d + t * (c + t * (b + a * t))));
+            output.new_velocity = e + t * (2 * d + t * (3 * c + t * (4 * b + 5 * a * t)));
+            output.new_acceleration = 2 * d + t * (6 * c + t * (12 * b + t * (20 * a)));
         }
 
-        output.new_position = f + t * (e + t * (d + t * (c + t * (b + a * t))));
-        output.new_velocity = e + t * (2 * d + t * (3 * c + t * (4 * b + 5 * a * t)));
-        output.new_acceleration = 2 * d + t * (6 * c + t * (12 * b + t * (20 * a)));
-
         current_input.current_position = output.new_position;
         current_input.current_velocity = output.new_velocity;
         current_input.current_acceleration = output.new_acceleration;
-        return Result::Working;
+        return is_finished ? Result::Finished : Result::Working;
+    }
+
+    //! Sample the last calculated trajectory at the times t0 + i dt into buffers with a row per sample and a column per DoF
+    void sample(double t0, double dt, Eigen::Ref<Eigen::MatrixXd> positions, Eigen::Ref<Eigen::MatrixXd> velocities, Eigen::Ref<Eigen::MatrixXd> accelerations) const {
+        for (Eigen::Index i = 0; i < positions.rows(); i += 1) {
+            const double time = t0 + i * dt;
+            if (time >= tf) {
+                positions.row(i) = current_input.target_position.transpose();
+                velocities.row(i) = current_input.target_velocity.transpose();
+                accelerations.row(i) = current_input.target_acceleration.transpose();
+                continue;
+            }
+
+            positions.row(i) = (f + time * (e + time * (d + time * (c + time * (b + a * time))))).transpose();
+            velocities.row(i) = (e + time * (2 * d + time * (3 * c + time * (4 * b + 5 * a * time)))).transpose();
+            accelerations.row(i) = (2 * d + time * (6 * c + time * (12 * b + time * (20 * a)))).transpose();
+        }
     }
 };
 
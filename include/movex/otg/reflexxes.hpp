@@ -27,35 +27,59 @@ class Reflexxes {
     RMLPositionFlags flags;
     RMLVelocityFlags vel_flags;
 
+    void initialize() {
+        rml = std::make_shared<ReflexxesAPI>(degrees_of_freedom, delta_time);
+        input_parameters = std::make_shared<RMLPositionInputParameters>(degrees_of_freedom);
+        output_parameters = std::make_shared<RMLPositionOutputParameters>(degrees_of_freedom);
+        input_vel_parameters = std::make_shared<RMLVelocityInputParameters>(degrees_of_freedom);
+        output_vel_parameters = std::make_shared<RMLVelocityOutputParameters>(degrees_of_freedom);
+
+        flags.SynchronizationBehavior = RMLPositionFlags::PHASE_SYNCHRONIZATION_IF_POSSIBLE;
+        vel_flags.SynchronizationBehavior = RMLVelocityFlags::PHASE_SYNCHRONIZATION_IF_POSSIBLE;
+    }
+
 public:
+    const size_t degrees_of_freedom;
     double delta_time;
 
-    explicit Reflexxes(double delta_time): delta_time(delta_time) {
-        rml = std::make_shared<ReflexxesAPI>(DOFs, delta_time);
-        input_parameters = std::make_shared<RMLPositionInputParameters>(DOFs);
-        output_parameters = std::make_shared<RMLPositionOutputParameters>(DOFs);
-        input_vel_parameters = std::make_shared<RMLVelocityInputParameters>(DOFs);
-        output_vel_parameters = std::make_shared<RMLVelocityOutputParameters>(DOFs);
+    template<size_t D = DOFs, std::enable_if_t<(D >= 1), int> = 0>
+    explicit Reflexxes(double delta_time): degrees_of_freedom(DOFs), delta_time(delta_time) {
+        initialize();
+    }
 
-        flags.SynchronizationBehavior = RMLPositionFlags::PHASE_SYNCHRONIZATION_IF_POSSIBLE;
-        vel_flags.SynchronizationBehavior = RMLVelocityFlags::PHASE_SYNCHRONIZATION_IF_POSSIBLE;
+    template<size_t D = DOFs, std::enable_if_t<(D == 0), int> = 0>
+    explicit Reflexxes(size_t degrees_of_freedom, double delta_time): current_input(degrees_of_freedom), degrees_of_freedom(degrees_of_freedom), delta_time(delta_time) {
+        initialize();
     }
 
     Result update(const InputParameter<DOFs>& input, OutputParameter<DOFs>& output) {
-        if (input != current_input) {
+        if (input.has_changed(current_input)) {
             current_input = input;
 
             if ((input.target_acceleration.array() != 0.0).any()) {
                 return Result::Error;
             }
 
+            if (input.synchronization == InputParameter<DOFs>::Synchronization::Phase) {
+                flags.SynchronizationBehavior = RMLPositionFlags::PHASE_SYNCHRONIZATION_IF_POSSIBLE;
+                vel_flags.SynchronizationBehavior = RMLVelocityFlags::PHASE_SYNCHRONIZATION_IF_POSSIBLE;
+            } else if (input.synchronization == InputParameter<DOFs>::Synchronization::None) {
+                flags.SynchronizationBehavior = RMLPositionFlags::NO_SYNCHRONIZATION;
+                vel_flags.SynchronizationBehavior = RMLVelocityFlags::NO_SYNCHRONIZATION;
+            } else {
+                flags.SynchronizationBehavior = RMLPositionFlags::ONLY_TIME_SYNCHRONIZATION;
+                vel_flags.SynchronizationBehavior = RMLVelocityFlags::ONLY_TIME_SYNCHRONIZATION;
+            }
+
             switch (input.type) {
             case InputParameter<DOFs>::Type::Position: {
                 if (input.minimum_duration.has_value()) {
                     input_parameters->SetMinimumSynchronizationTime(input.minimum_duration.value());
                 }
 
-                input_parameters->SetSelectionVector(input.enabled.data());
+                for (size_t i = 0; i < degrees_of_freedom; i += 1) {
+                    input_parameters->SetSelectionVectorElement(input.enabled[i], i);
+                }
                 input_parameters->SetCurrentPositionVector(input.current_position.data());
                 input_parameters->SetCurrentVelocityVector(input.current_velocity.data());
                 input_parameters->SetCurrentAccelerationVector(input.current_acceleration.data());
@@ -70,7 +94,9 @@ public:
                     input_vel_parameters->SetMinimumSynchronizationTime(input.minimum_duration.value());
                 }
 
-                input_vel_parameters->SetSelectionVector(input.enabled.data());
+                for (size_t i = 0; i < degrees_of_freedom; i += 1) {
+                    input_vel_parameters->SetSelectionVectorElement(input.enabled[i], i);
+                }
                 input_vel_parameters->SetCurrentPositionVector(input.current_position.data());
                 input_vel_parameters->SetCurrentVelocityVector(input.current_velocity.data());
                 input_vel_parameters->SetCurrentAccelerationVector(input.current_acceleration.data());
@@ -85,25 +111,38 @@ public:
         case InputParameter<DOFs>::Type::Position: {
             result_value = rml->RMLPosition(*input_parameters, output_parameters.get(), flags);
 
-            for (size_t i = 0; i < DOFs; i += 1) {
+            for (size_t i = 0; i < degrees_of_freedom; i += 1) {
                 output.new_position(i) = output_parameters->NewPositionVector->VecData[i];
                 output.new_velocity(i) = output_parameters->NewVelocityVector->VecData[i];
                 output.new_acceleration(i) = output_parameters->NewAccelerationVector->VecData[i];
             }
             output.duration = output_parameters->GetSynchronizationTime();
+
+            // Continue from the new state if the input is unchanged in the next cycle
+            *input_parameters->CurrentPositionVector = *output_parameters->NewPositionVector;
+            *input_parameters->CurrentVelocityVector = *output_parameters->NewVelocityVector;
+            *input_parameters->CurrentAccelerationVector = *output_parameters->NewAccelerationVector;
         } break;
         case InputParameter<DOFs>::Type::Velocity: {
             result_value = rml->RMLVelocity(*input_vel_parameters, output_vel_parameters.get(), vel_flags);
 
-            for (size_t i = 0; i < DOFs; i += 1) {
+            for (size_t i = 0; i < degrees_of_freedom; i += 1) {
                 output.new_position(i) = output_vel_parameters->NewPositionVector->VecData[i];
                 output.new_velocity(i) = output_vel_parameters->NewVelocityVector->VecData[i];
                 output.new_acceleration(i) = output_vel_parameters->NewAccelerationVector->VecData[i];
             }
             output.duration = output_vel_parameters->GetSynchronizationTime();
+
+            *input_vel_parameters->CurrentPositionVector = *output_vel_parameters->NewPositionVector;
+            *input_vel_parameters->CurrentVelocityVector = *output_vel_parameters->NewVelocityVector;
+            *input_vel_parameters->CurrentAccelerationVector = *output_vel_parameters->NewAccelerationVector;
         } break;
         }
 
+        current_input.current_position = output.new_position;
+        current_input.current_velocity = output.new_velocity;
+        current_input.current_acceleration = output.new_acceleration;
+
         if (result_value == ReflexxesAPI::RML_FINAL_STATE_REACHED) {
             return Result::Finished;
         } else if (result_value < 0) {
@@ -117,7 +156,7 @@ public:
         case InputParameter<DOFs>::Type::Position: {
             rml->RMLPositionAtAGivenSampleTime(time, output_parameters.get());
 
-            for (size_t i = 0; i < DOFs; i += 1) {
+            for (size_t i = 0; i < degrees_of_freedom; i += 1) {
                 output.new_position(i) = output_parameters->NewPositionVector->VecData[i];
                 output.new_velocity(i) = output_parameters->NewVelocityVector->VecData[i];
                 output.new_acceleration(i) = output_parameters->NewAccelerationVector->VecData[i];
@@ -126,7 +165,7 @@ public:
         case InputParameter<DOFs>::Type::Velocity: {
             rml->RMLVelocityAtAGivenSampleTime(time, output_vel_parameters.get());
 
-            for (size_t i = 0; i < DOFs; i += 1) {
+            for (size_t i = 0; i < degrees_of_freedom; i += 1) {
                 output.new_position(i) = output_vel_parameters->NewPositionVector->VecData[i];
                 output.new_velocity(i) = output_vel_parameters->NewVelocityVector->VecData[i];
                 output.new_acceleration(i) = output_vel_parameters->NewAccelerationVector->VecData[i];
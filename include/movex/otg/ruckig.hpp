@@ -1,14 +1,29 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
-#include <iostream>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
 #include <optional>
+#include <string>
+#include <utility>
 
 #include <movex/otg/parameter.hpp>
+#include <movex/otg/worker_pool.hpp>
 
 
 namespace movex {
 
+//! Minimal and maximal position of a trajectory and the (first) times they are reached
+struct PositionExtrema {
+    double min, max;
+    double t_min, t_max;
+};
+
+
 struct Profile {
     //! Profile names indicate which limits are reached.
     enum class Type {
@@ -29,31 +44,270 @@ struct Profile {
     void set(double p0, double v0, double a0, std::array<double, 7> j);
     bool check(double pf, double vf, double vMax, double aMax) const;
 
+    //! Check a profile of the time synchronization, which needs to have the duration tf
+    bool check(double tf, double pf, double vf, double vMax, double aMax) const;
+
+    //! Check a profile of the velocity interface, which has no target position
+    bool check_for_velocity(double vf, double af, double aMax) const;
+
+    //! Set the braking segments (if the input exceeds or will exceed limits). Returns the state at the start of the "correct" profile.
+    std::tuple<double, double, double> set_brake(double p0, double v0, double a0, double vMax, double aMax, double jMax);
+
+    //! Profile with the same timing, but positions, velocities, accelerations, and jerks scaled by factor (relative to the initial position p0_reference)
+    Profile scale(double factor, double p0, double p0_reference) const;
+
+    //! Duration including the braking segments
+    double duration() const {
+        return t_brake.value_or(0.0) + t_sum[6];
+    }
+
+    //! Number of segments: two braking segments, the seven phases of the profile, and the final state
+    static constexpr size_t segments {10};
+
+    //! Time (including braking) when the segment with the given index ends
+    double segment_end(size_t index) const {
+        if (index < 2) {
+            return (index == 0) ? t_brakes[0] : t_brake.value_or(0.0);
+        } else if (index < segments - 1) {
+            return t_brake.value_or(0.0) + t_sum[index - 2];
+        }
+        return std::numeric_limits<double>::infinity();
+    }
+
+    //! Position, velocity, and acceleration at the given time within the segment with the given index.
+    void state_at_segment(size_t index, double time, double& p_new, double& v_new, double& a_new) const {
+        if (index < 2) {
+            const double t_start = (index == 0) ? 0.0 : t_brakes[0];
+            std::tie(p_new, v_new, a_new) = integrate(time - t_start, p_brakes[index], v_brakes[index], a_brakes[index], j_brakes[index]);
+        } else if (index < segments - 1) {
+            const double t_start = t_brake.value_or(0.0) + ((index > 2) ? t_sum[index - 3] : 0.0);
+            std::tie(p_new, v_new, a_new) = integrate(time - t_start, p[index - 2], v[index - 2], a[index - 2], j[index - 2]);
+        } else {
+            // Continue with the final velocity and acceleration
+            std::tie(p_new, v_new, a_new) = integrate(time - duration(), p[7], v[7], a[7], 0.0);
+        }
+    }
+
+    //! Position, velocity, and acceleration at the given time, including the braking segments.
+    void state_at_time(double time, double& p_new, double& v_new, double& a_new) const;
+
+    //! Calls func(t_start, t, p0, v0, a0, j) for all segments with constant jerk in order, from the braking to the last phase of the profile
+    template<class Func>
+    void for_each_segment(Func func) const {
+        double t_start {0.0};
+        if (t_brake.has_value() && t_brake.value() > 0.0) {
+            // Same timing as state_at_time, the profile always starts at t_brake
+            const double t_first = std::min(t_brakes[0], t_brake.value());
+            func(0.0, t_first, p_brakes[0], v_brakes[0], a_brakes[0], j_brakes[0]);
+            if (t_brake.value() > t_first) {
+                func(t_first, t_brake.value() - t_first, p_brakes[1], v_brakes[1], a_brakes[1], j_brakes[1]);
+            }
+            t_start = t_brake.value();
+        }
+
+        for (size_t i = 0; i < 7; i += 1) {
+            if (t[i] > 0.0) {
+                func(t_start, t[i], p[i], v[i], a[i], j[i]);
+                t_start += t[i];
+            }
+        }
+    }
+
+    //! Extrema of the position from the start until the end of the profile, where the velocity is zero or at the segment boundaries
+    PositionExtrema get_position_extrema() const;
+
+    //! First time when the profile reaches the given position, e.g. to schedule an event. Returns false if the position isn't reached.
+    bool get_first_time_at_position(double position, double& time) const;
+
+    //! Sample the n times t0 + i dt (with dt > 0) into contiguous buffers, evaluating the samples of each segment in a single loop
+    void sample(double t0, double dt, size_t n, double* positions, double* velocities, double* accelerations) const;
+
     //! Integrate with constant jerk for duration t. Returns new position, new velocity, and new acceleration.
     static std::tuple<double, double, double> integrate(double t, double p0, double v0, double a0, double j);
 };
 
 
+//! Remembers the recently found profile types of a DoF, so that the likely ones are tried first in step 1
+struct ProfileCache {
+    static constexpr size_t capacity {4};
+
+    //! Recently found profile types, the most recent one first
+    std::array<Profile::Type, capacity> recent;
+    size_t length {0};
+
+    //! Number of calculations where a recent type matched (hit) or the full search was needed (miss)
+    size_t hits {0}, misses {0};
+
+    void remember(Profile::Type type);
+
+    double hit_rate() const {
+        return (hits + misses > 0) ? static_cast<double>(hits) / (hits + misses) : 0.0;
+    }
+};
+
+
+/**
+ * Optional runtime statistics of Ruckig, e.g. to find out which profile types are expensive for the real motion mix.
+ * There is only a single writer (the calculating thread), and all counters can be read lock-free from other threads.
+ */
+class RuckigStatistics {
+    using Counter = std::atomic<uint64_t>;
+
+    static void increment(Counter& counter) {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+public:
+    static constexpr size_t number_types {16};
+    static constexpr size_t number_bins {16};
+    using Histogram = std::array<uint64_t, number_bins>;
+
+    //! Upper bound of the bin in [µs], bins are logarithmic from 0.125µs to 2048µs, the last bin is unbounded
+    static double bin_upper_bound(size_t bin) {
+        return (bin + 1 < number_bins) ? std::ldexp(1.0, static_cast<int>(bin) - 3) : std::numeric_limits<double>::infinity();
+    }
+
+    static size_t bin(double duration) {
+        size_t result {0};
+        while (result + 1 < number_bins && duration >= bin_upper_bound(result)) {
+            result += 1;
+        }
+        return result;
+    }
+
+    Counter calculations {0};
+    Counter brakes {0}; ///< Number of DoFs with a brake pre-trajectory
+    Counter step1_fallbacks {0}; ///< Number of DoFs where Step 1 needed to search the next duration
+    Counter step2_fallbacks {0}; ///< Number of DoFs where Step 2 needed to continue with a longer duration
+    Counter failures {0};
+
+    //! Duration of whole calculations
+    std::array<Counter, number_bins> calculation_histogram {};
+
+    //! Duration of Step 1 of a single DoF by the resulting profile type
+    std::array<std::array<Counter, number_bins>, number_types> step1_histograms {};
+
+    void record_calculation(double duration) {
+        increment(calculations);
+        increment(calculation_histogram[bin(duration)]);
+    }
+
+    void record_step1(Profile::Type type, double duration) {
+        increment(step1_histograms[static_cast<size_t>(type)][bin(duration)]);
+    }
+
+    void record_brake() { increment(brakes); }
+    void record_step1_fallback() { increment(step1_fallbacks); }
+    void record_step2_fallback() { increment(step2_fallbacks); }
+    void record_failure() { increment(failures); }
+
+    Histogram get_calculation_histogram() const {
+        return load(calculation_histogram);
+    }
+
+    Histogram get_step1_histogram(Profile::Type type) const {
+        return load(step1_histograms[static_cast<size_t>(type)]);
+    }
+
+    //! Not atomic with respect to a concurrent calculation
+    void reset();
+
+private:
+    static Histogram load(const std::array<Counter, number_bins>& histogram) {
+        Histogram result;
+        for (size_t i = 0; i < number_bins; i += 1) {
+            result[i] = histogram[i].load(std::memory_order_relaxed);
+        }
+        return result;
+    }
+};
+
+
+//! Range of durations for which a DoF can't reach its target, e.g. due to a non-zero initial and target acceleration
+struct BlockedInterval {
+    double left, right;
+
+    //! Profile with the duration right if known, so that Step 2 doesn't need to find it at the boundary of the reachable durations
+    std::optional<Profile> right_profile;
+
+    bool contains(double time) const {
+        return left < time && time < right;
+    }
+};
+
+
+//! Blocked intervals of a DoF after its minimal duration in increasing order, a target position blocks up to two of them
+struct Block {
+    std::array<BlockedInterval, 2> intervals;
+    size_t size {0};
+
+    //! The blocked interval containing the given duration, or null if it is reachable
+    const BlockedInterval* find(double time) const {
+        const auto end = intervals.begin() + size;
+        const auto interval = std::find_if(intervals.begin(), end, [time](const BlockedInterval& i) { return i.contains(time); });
+        return (interval != end) ? &(*interval) : nullptr;
+    }
+};
+
+
+//! Valid profiles of Step 1 for all profile types and all roots of their equations
+struct ValidProfiles {
+    //! A DoF reaches its target with up to five distinct durations (the minimal one and the ends of two blocked intervals)
+    static constexpr size_t capacity {8};
+
+    std::array<Profile, capacity> profiles;
+    size_t size {0};
+
+    //! Keeps a copy of the profile if it reaches the target within the limits. A duration that was found before (e.g. by two types
+    //! if a plateau vanishes) is skipped, so that the order of the types decides between equally fast profiles.
+    void add_if_valid(const Profile& profile, double pf, double vf, double vMax, double aMax) {
+        if (size == capacity || !profile.check(pf, vf, vMax, aMax)) {
+            return;
+        }
+
+        const double duration = profile.t_sum[6];
+        if (std::any_of(profiles.begin(), profiles.begin() + size, [duration](const Profile& p) { return std::abs(p.t_sum[6] - duration) < 1e-8; })) {
+            return;
+        }
+
+        profiles[size] = profile;
+        size += 1;
+    }
+};
+
+
+/**
+ * Time-optimal profile of a DoF. All profile types and all roots are evaluated, as a non-zero initial state or target velocity
+ * might give several valid profiles: the fastest one, and the ends of the blocked intervals between the others.
+ */
 struct RuckigStep1 {
-    static bool time_up_acc0_acc1_vel(Profile& profile, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax);
-    static bool time_up_acc1_vel(Profile& profile, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax);
-    static bool time_up_acc0_vel(Profile& profile, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax);
-    static bool time_up_vel(Profile& profile, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax);
-    static bool time_up_acc0_acc1(Profile& profile, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax);
-    static bool time_up_acc1(Profile& profile, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax);
-    static bool time_up_acc0(Profile& profile, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax);
-    static bool time_up_none(Profile& profile, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax);
-
-    static bool time_down_acc0_acc1_vel(Profile& profile, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax);
-    static bool time_down_acc1_vel(Profile& profile, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax);
-    static bool time_down_acc0_vel(Profile& profile, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax);
-    static bool time_down_vel(Profile& profile, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax);
-    static bool time_down_acc0_acc1(Profile& profile, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax);
-    static bool time_down_acc1(Profile& profile, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax);
-    static bool time_down_acc0(Profile& profile, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax);
-    static bool time_down_none(Profile& profile, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax);
-
-    static bool get_profile(Profile& profile, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax);
+    static void time_up_acc0_acc1_vel(Profile& profile, ValidProfiles& valid, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax);
+    static void time_up_acc1_vel(Profile& profile, ValidProfiles& valid, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax);
+    static void time_up_acc0_vel(Profile& profile, ValidProfiles& valid, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax);
+    static void time_up_vel(Profile& profile, ValidProfiles& valid, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax);
+    static void time_up_acc0_acc1(Profile& profile, ValidProfiles& valid, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax);
+    static void time_up_acc1(Profile& profile, ValidProfiles& valid, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax);
+    static void time_up_acc0(Profile& profile, ValidProfiles& valid, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax);
+    static void time_up_none(Profile& profile, ValidProfiles& valid, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax);
+
+    static void time_down_acc0_acc1_vel(Profile& profile, ValidProfiles& valid, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax);
+    static void time_down_acc1_vel(Profile& profile, ValidProfiles& valid, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax);
+    static void time_down_acc0_vel(Profile& profile, ValidProfiles& valid, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax);
+    static void time_down_vel(Profile& profile, ValidProfiles& valid, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax);
+    static void time_down_acc0_acc1(Profile& profile, ValidProfiles& valid, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax);
+    static void time_down_acc1(Profile& profile, ValidProfiles& valid, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax);
+    static void time_down_acc0(Profile& profile, ValidProfiles& valid, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax);
+    static void time_down_none(Profile& profile, ValidProfiles& valid, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax);
+
+    //! Add the valid profiles of the given type
+    static void time_profile(Profile& profile, ValidProfiles& valid, Profile::Type type, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax);
+
+    //! Keeps the braking segments of the given profile, the durations of the block include them
+    static bool get_profile(Profile& profile, Block& block, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax);
+
+    //! Try the recently found profile types of the cache first, then fall back to the full search. With a cache hit, the profile
+    //! is the fastest one of the cached type, so that it might not be time-optimal, and the block is left empty.
+    static bool get_profile(Profile& profile, Block& block, ProfileCache& cache, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax);
 
     static void get_brake_trajectory(double v0, double a0, double vMax, double aMax, double jMax, std::array<double, 2>& t_brake, std::array<double, 2>& j_brake);
 };
@@ -78,208 +332,1004 @@ struct RuckigStep2 {
     static bool time_down_acc0(Profile& profile, double tf, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax);
     static bool time_down_none(Profile& profile, double tf, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax);
 
-    static bool get_profile(Profile& profile, double tf, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax);
+    // Numeric fallbacks, only used if none of the closed-form profiles matches. The plateau profile is the last case for a given
+    // duration, e.g. for some non-zero target velocities, and evaluates at most (plateau_grid_size + 1 + plateau_bisections) = 86
+    // plateau profiles. The next duration is searched only if the brake trajectory ends in a state, from which none of the Step 1
+    // profiles stays within the limits. It calls get_profile at most (next_duration_expansions + next_duration_bisections + 2) = 66 times.
+    // Both searches give up at an optional deadline, so that a computation budget also bounds their cost.
+
+    //! Point in time after which the numeric searches give up, e.g. at the end of a computation budget
+    using Deadline = std::chrono::high_resolution_clock::time_point;
+    static constexpr Deadline no_deadline {Deadline::max()};
+
+    static bool is_past(Deadline deadline) {
+        return deadline != no_deadline && std::chrono::high_resolution_clock::now() > deadline;
+    }
+
+    //! Intervals of the plateau velocity within [-vMax, vMax] to find the sign change of the position error
+    static constexpr size_t plateau_grid_size {32};
+
+    //! Halving a grid interval 53 times reaches the double precision (53 bit mantissa) of the plateau velocity
+    static constexpr size_t plateau_bisections {53};
+
+    //! First step after tf is the larger of a 1ms control cycle and 1% of tf, shorter reachable windows might be skipped
+    static constexpr double next_duration_min_step {1e-3};
+    static constexpr double next_duration_relative_step {0.01};
+
+    //! Doubling steps, covering durations up to 2^25 times the first step after tf (more than 9h for 1ms)
+    static constexpr size_t next_duration_expansions {24};
+
+    //! Bisections of the last step down to 1e-9s, sufficient for a last step of 2^40ns (about 18min)
+    static constexpr size_t next_duration_bisections {40};
+    static constexpr double next_duration_precision {1e-9};
+
+    /**
+     * Velocity profiles to and from a cruising velocity, which is found by bisection. The type is set by the limits that
+     * the profile reaches, and by the direction of its first jerk. The second half might have another jerk pattern than the closed-form type.
+     */
+    static bool time_vel_plateau(Profile& profile, double tf, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax, Deadline deadline = no_deadline);
+
+    static bool get_profile(Profile& profile, double tf, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax, Deadline deadline = no_deadline);
+
+    /**
+     * First duration after tf for which a profile exists, tf is updated in-place. Found by an exponential search and bisection,
+     * so it isn't guaranteed to be the shortest one if a reachable window is shorter than the search step.
+     */
+    static bool get_next_duration(Profile& profile, double& tf, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax, Deadline deadline = no_deadline);
+};
+
+
+//! Time-optimal profile of the velocity interface, reaching a target velocity and acceleration without a target position.
+struct VelocityStep1 {
+    static bool time_up_acc0(Profile& profile, double p0, double v0, double a0, double vf, double af, double aMax, double jMax);
+    static bool time_up_none(Profile& profile, double p0, double v0, double a0, double vf, double af, double aMax, double jMax);
+
+    static bool time_down_acc0(Profile& profile, double p0, double v0, double a0, double vf, double af, double aMax, double jMax);
+    static bool time_down_none(Profile& profile, double p0, double v0, double a0, double vf, double af, double aMax, double jMax);
+
+    static bool get_profile(Profile& profile, double p0, double v0, double a0, double vf, double af, double aMax, double jMax);
+
+    //! Durations longer than the minimal duration t_min that can't be synchronized. Returns false if there are none.
+    static bool get_blocked_interval(double t_min, double v0, double a0, double vf, double af, double aMax, double jMax, BlockedInterval& interval);
+};
+
+
+//! Profile of the velocity interface with the given duration tf.
+struct VelocityStep2 {
+    //! Jerk j1 to a constant acceleration plateau, then jerk j3 to the target acceleration
+    static bool time_plateau(Profile& profile, double tf, double p0, double v0, double a0, double vf, double af, double aMax, double j1, double j3);
+
+    //! Reduced jerk to a peak acceleration and back to the target acceleration
+    static bool time_none(Profile& profile, double tf, double p0, double v0, double a0, double vf, double af, double aMax, double jMax);
+
+    static bool get_profile(Profile& profile, double tf, double p0, double v0, double a0, double vf, double af, double aMax, double jMax);
+};
+
+
+//! Details about the last failed calculation. It is preallocated, so that filling it in the real-time thread doesn't allocate.
+struct CalculationError {
+    Result result {Result::Working};
+    size_t dof {0};
+
+    //! Input of the failing profile of the DoF, after braking and without the target acceleration segment
+    double p0, v0, a0, pf, vf, af, vMax, aMax, jMax;
+
+    //! Human-readable description, which allocates and should not be called from the real-time thread
+    std::string to_string() const;
+};
+
+
+template<size_t DOFs> class Ruckig;
+
+
+/**
+ * A calculated trajectory of Ruckig. It is immutable and independent of the generator, so it can be copied and sampled e.g. by another thread.
+ */
+template<size_t DOFs>
+class RuckigTrajectory {
+    using Vector = typename InputParameter<DOFs>::Vector;
+
+    StandardVector<Profile, DOFs> profiles;
+    double duration {0.0};
+
+    //! Disabled DoFs keep their initial state
+    StandardVector<bool, DOFs> enabled;
+    Vector initial_position, initial_velocity, initial_acceleration;
+
+    /**
+     * Start time, end time, and initial state of the non-empty segments of all profiles, precomputed after the calculation.
+     * Each segment holds a vector over all DoFs (structure of arrays). After the last non-empty segment of a DoF, the final
+     * state continues until infinity, so that the remaining segments are never reached.
+     */
+    std::array<Vector, Profile::segments> t_starts, t_ends, ps, vs, as, js;
+
+    friend class Ruckig<DOFs>;
+
+    //! Precompute the segments from the profiles, needs to be called after each calculation
+    void set_segments() {
+        constexpr double inf {std::numeric_limits<double>::infinity()};
+        for (size_t dof = 0; dof < profiles.size(); dof += 1) {
+            const Profile& profile = profiles[dof];
+
+            size_t index {0};
+            auto set_segment = [&](double t_start, double t_end, double p0, double v0, double a0, double jerk) {
+                t_starts[index][dof] = t_start;
+                t_ends[index][dof] = t_end;
+                ps[index][dof] = p0;
+                vs[index][dof] = v0;
+                as[index][dof] = a0;
+                js[index][dof] = jerk;
+                index += 1;
+            };
+
+            profile.for_each_segment([&](double t_start, double t, double p0, double v0, double a0, double jerk) {
+                set_segment(t_start, t_start + t, p0, v0, a0, jerk);
+            });
+
+            // Continue with the final velocity and acceleration
+            set_segment(profile.duration(), inf, profile.p[7], profile.v[7], profile.a[7], 0.0);
+
+            for (; index < Profile::segments; index += 1) {
+                t_starts[index][dof] = inf;
+                t_ends[index][dof] = inf;
+            }
+        }
+    }
+
+    //! State of a DoF at the given time within the segment with the given index, with a Horner scheme of the polynomials
+    void state_at_segment(size_t index, size_t dof, double time, double& p_new, double& v_new, double& a_new) const {
+        const double t = time - t_starts[index][dof];
+        const double p0 = ps[index][dof], v0 = vs[index][dof], a0 = as[index][dof], j = js[index][dof];
+        p_new = p0 + t * (v0 + t * (a0 / 2 + t * j / 6));
+        v_new = v0 + t * (a0 + t * j / 2);
+        a_new = a0 + t * j;
+    }
+
+public:
+    template<size_t D = DOFs, std::enable_if_t<(D >= 1), int> = 0>
+    RuckigTrajectory() { }
+
+    template<size_t D = DOFs, std::enable_if_t<(D == 0), int> = 0>
+    explicit RuckigTrajectory(size_t degrees_of_freedom): profiles(degrees_of_freedom), enabled(degrees_of_freedom), initial_position(degrees_of_freedom), initial_velocity(degrees_of_freedom), initial_acceleration(degrees_of_freedom) {
+        for (auto segments: {&t_starts, &t_ends, &ps, &vs, &as, &js}) {
+            for (Vector& segment: *segments) {
+                segment.resize(degrees_of_freedom);
+            }
+        }
+    }
+
+    /**
+     * Samples a trajectory at monotonically increasing times with an amortized O(1) lookup of the current segment.
+     * The cursor only stores the segment indices, so that it can be copied together with its owner. The trajectory is passed
+     * to each call, and needs to be the one of the last reset.
+     */
+    class Cursor {
+        StandardVector<size_t, DOFs> indices;
+        double last_time {0.0};
+
+    public:
+        explicit Cursor(const RuckigTrajectory<DOFs>& trajectory) {
+            reset(trajectory);
+        }
+
+        //! Restart the cursor at the beginning of the given trajectory, without allocating for the same number of DoFs
+        void reset(const RuckigTrajectory<DOFs>& trajectory) {
+            if constexpr (DOFs == 0) {
+                indices.resize(trajectory.profiles.size());
+            }
+            std::fill(indices.begin(), indices.end(), 0);
+            last_time = 0.0;
+        }
+
+        //! Sample the trajectory at the given time. If the time decreases, the cursor restarts from the beginning.
+        void at_time(const RuckigTrajectory<DOFs>& trajectory, double time, Vector& new_position, Vector& new_velocity, Vector& new_acceleration) {
+            if (time < last_time) {
+                std::fill(indices.begin(), indices.end(), 0);
+            }
+            last_time = time;
+
+            for (size_t dof = 0; dof < indices.size(); dof += 1) {
+                if (!trajectory.enabled[dof]) {
+                    new_position[dof] = trajectory.initial_position[dof];
+                    new_velocity[dof] = trajectory.initial_velocity[dof];
+                    new_acceleration[dof] = trajectory.initial_acceleration[dof];
+                    continue;
+                }
+
+                size_t& index = indices[dof];
+                while (index < Profile::segments - 1 && time >= trajectory.t_ends[index][dof]) {
+                    index += 1;
+                }
+                trajectory.state_at_segment(index, dof, time, new_position[dof], new_velocity[dof], new_acceleration[dof]);
+            }
+        }
+    };
+
+    size_t get_degrees_of_freedom() const {
+        return profiles.size();
+    }
+
+    //! Duration of the synchronized trajectory in [s]
+    double get_duration() const {
+        return duration;
+    }
+
+    //! Profile (including braking segments) of the given DoF
+    const Profile& get_profile(size_t dof) const {
+        return profiles[dof];
+    }
+
+    bool is_enabled(size_t dof) const {
+        return enabled[dof];
+    }
+
+    //! Sample the trajectory at an arbitrary time
+    void at_time(double time, Vector& new_position, Vector& new_velocity, Vector& new_acceleration) const {
+        for (size_t dof = 0; dof < profiles.size(); dof += 1) {
+            if (!enabled[dof]) {
+                new_position[dof] = initial_position[dof];
+                new_velocity[dof] = initial_velocity[dof];
+                new_acceleration[dof] = initial_acceleration[dof];
+                continue;
+            }
+
+            // Number of segments that have already ended, without branches
+            size_t index {0};
+            for (size_t i = 0; i < Profile::segments - 1; i += 1) {
+                index += (time >= t_ends[i][dof]);
+            }
+            state_at_segment(index, dof, time, new_position[dof], new_velocity[dof], new_acceleration[dof]);
+        }
+    }
+
+    Cursor cursor() const {
+        return Cursor(*this);
+    }
+
+    //! Minimal and maximal position of each DoF within the duration, calculated analytically from the segments of the profiles
+    StandardVector<PositionExtrema, DOFs> get_position_extrema() const {
+        StandardVector<PositionExtrema, DOFs> result;
+        if constexpr (DOFs == 0) {
+            result.resize(profiles.size());
+        }
+
+        for (size_t dof = 0; dof < profiles.size(); dof += 1) {
+            if (!enabled[dof]) {
+                result[dof] = {initial_position[dof], initial_position[dof], 0.0, 0.0};
+                continue;
+            }
+
+            result[dof] = profiles[dof].get_position_extrema();
+        }
+        return result;
+    }
+
+    //! First time within the duration when the DoF reaches the given position. Returns false if the position isn't reached.
+    bool get_first_time_at_position(size_t dof, double position, double& time) const {
+        if (!enabled[dof]) {
+            time = 0.0;
+            return (position == initial_position[dof]);
+        }
+
+        return profiles[dof].get_first_time_at_position(position, time);
+    }
+
+    /**
+     * Sample the trajectory at the times t0 + i dt for all rows i of the buffers, e.g. for plotting or offline simulation.
+     * The buffers have a column per DoF, so that the samples of each DoF are contiguous (structure of arrays).
+     */
+    void sample(double t0, double dt, Eigen::Ref<Eigen::MatrixXd> positions, Eigen::Ref<Eigen::MatrixXd> velocities, Eigen::Ref<Eigen::MatrixXd> accelerations) const {
+        const size_t n = positions.rows();
+        for (size_t dof = 0; dof < profiles.size(); dof += 1) {
+            if (!enabled[dof]) {
+                positions.col(dof).setConstant(initial_position[dof]);
+                velocities.col(dof).setConstant(initial_velocity[dof]);
+                accelerations.col(dof).setConstant(initial_acceleration[dof]);
+                continue;
+            }
+
+            profiles[dof].sample(t0, dt, n, positions.col(dof).data(), velocities.col(dof).data(), accelerations.col(dof).data());
+        }
+    }
 };
 
 
 template<size_t DOFs>
 class Ruckig {
     InputParameter<DOFs> current_input;
+    InputParameter<DOFs> stop_input; // Of the fallback without a previous trajectory
 
-    double t, tf;
-    std::array<Profile, DOFs> profiles;
+    double t;
+    RuckigTrajectory<DOFs> trajectory;
+    RuckigTrajectory<DOFs> next_trajectory; // With a computation budget, the current trajectory stays valid until the next one is found
+    typename RuckigTrajectory<DOFs>::Cursor cursor {trajectory};
+    bool has_trajectory {false};
+    CalculationError error;
 
-    bool calculate(const InputParameter<DOFs>& input, OutputParameter<DOFs>& output) {
-        current_input = input;
+    // Preallocated storage of the calculation
+    StandardVector<double, DOFs> tfs; // Profile duration
+    StandardVector<double, DOFs> p0s, v0s, a0s; // Starting point of profiles without brake trajectory
+    StandardVector<double, DOFs> pfs, vfs; // Target of profiles without accelerating segment
+    StandardVector<Block, DOFs> blocks; // Durations after the minimal one that a DoF can't reach
+    StandardVector<double, DOFs> scales; // Of the phase synchronization
 
-        // Check input
-        if ((input.max_velocity.array() <= 0.0).any() || (input.max_acceleration.array() <= 0.0).any() || (input.max_jerk.array() <= 0.0).any()) {
-            return false;
+    //! Outcome of Step 1 or Step 2 of a single DoF, evaluated in the order of the DoFs after all DoFs are calculated
+    struct DofResult {
+        Result result {Result::Working};
+        bool is_fallback {false}; // Step 1 searched the next duration, or Step 2 needs to continue with the end of the blocked interval of this DoF
+        double step1_duration {-1}; // In [µs], only measured with statistics
+    };
+    StandardVector<DofResult, DOFs> dof_results;
+
+    Result calculate(const InputParameter<DOFs>& input, OutputParameter<DOFs>& output) {
+        if (!calculation_budget.has_value()) {
+            current_input = input;
+
+            const Result result = calculate(input, trajectory);
+            has_trajectory = (result == Result::Working);
+            if (result != Result::Working) {
+                return result;
+            }
+
+        } else {
+            // The current input is kept on failure, so that the calculation is retried in the next cycle
+            const Result result = calculate(input, next_trajectory);
+            if (result != Result::Working) {
+                return result;
+            }
+
+            current_input = input;
+            std::swap(trajectory, next_trajectory);
         }
 
-        if (DOFs > 1 && (input.target_velocity.array() != 0.0).any()) {
-            std::cerr << "Ruckig does not support a target velocity for multiple DoFs." << std::endl;
+        t = 0.0;
+        cursor.reset(trajectory);
+        output.duration = trajectory.duration;
+        has_trajectory = true;
+        return Result::Working;
+    }
+
+    //! Brake with the closed-form stop of each DoF, if there is no previous trajectory to follow. Returns false if no brake trajectory was found.
+    bool calculate_stop(const InputParameter<DOFs>& input, OutputParameter<DOFs>& output) {
+        stop_input = input;
+        stop_input.set_stop();
+        if (calculate_stop(stop_input, next_trajectory) != Result::Working) {
             return false;
         }
 
-        if ((input.target_velocity.array().abs() > input.max_velocity.array()).any()) {
-            std::cerr << "Target velocity exceeds maximal velocity." << std::endl;
+        current_input = stop_input;
+        std::swap(trajectory, next_trajectory);
+        t = 0.0;
+        cursor.reset(trajectory);
+        output.duration = trajectory.duration;
+        has_trajectory = true;
+        return true;
+    }
+
+    //! End of the computation budget of the calculation started at the given time
+    RuckigStep2::Deadline get_deadline(std::chrono::high_resolution_clock::time_point start) const {
+        if (!calculation_budget.has_value()) {
+            return RuckigStep2::no_deadline;
+        }
+        return start + std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(std::chrono::duration<double, std::micro>(calculation_budget.value()));
+    }
+
+    //! Fill the preallocated error record and return its result
+    Result set_error(Result result, size_t dof, double p0, double v0, double a0, double pf, double vf, double af, double vMax, double aMax, double jMax) {
+        error = {result, dof, p0, v0, a0, pf, vf, af, vMax, aMax, jMax};
+        if (statistics) {
+            statistics->record_failure();
+        }
+        return result;
+    }
+
+    //! Fill the error record with the profile input of the given DoF
+    Result set_error(Result result, size_t dof, const InputParameter<DOFs>& input) {
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+        if (result == Result::ErrorCalculationTimeout) {
+            return set_error(result, dof, nan, nan, nan, nan, nan, nan, nan, nan, nan);
+        } else if (input.type == InputParameter<DOFs>::Type::Velocity) {
+            return set_error(result, dof, p0s[dof], v0s[dof], a0s[dof], nan, input.target_velocity[dof], input.target_acceleration[dof], nan, input.max_acceleration[dof], input.max_jerk[dof]);
+        }
+        return set_error(result, dof, p0s[dof], v0s[dof], a0s[dof], pfs[dof], vfs[dof], input.target_acceleration[dof], input.max_velocity[dof], input.max_acceleration[dof], input.max_jerk[dof]);
+    }
+
+    //! Calls func(dof) for all DoFs, in parallel if there is a worker pool. If func returns false, the following DoFs might be skipped.
+    template<class Func>
+    void for_each_dof(const Func& func) {
+        if (worker_pool) {
+            worker_pool->for_each(degrees_of_freedom, func);
+            return;
+        }
+
+        for (size_t dof = 0; dof < degrees_of_freedom; dof += 1) {
+            if (!func(dof)) {
+                return;
+            }
+        }
+    }
+
+    //! Step 1 of a single DoF. Only the storage of this DoF is written, so that the DoFs can be calculated in parallel.
+    void calculate_step1(const InputParameter<DOFs>& input, StandardVector<Profile, DOFs>& profiles, size_t dof, RuckigStep2::Deadline deadline) {
+        DofResult& result = dof_results[dof];
+        result = DofResult {};
+        if (!input.enabled[dof]) {
+            tfs[dof] = 0.0;
+            return;
+        }
+
+        if (input.type == InputParameter<DOFs>::Type::Velocity) {
+            // Without a velocity limit, only an exceeded acceleration needs braking
+            std::tie(p0s[dof], v0s[dof], a0s[dof]) = profiles[dof].set_brake(input.current_position[dof], input.current_velocity[dof], input.current_acceleration[dof], std::numeric_limits<double>::infinity(), input.max_acceleration[dof], input.max_jerk[dof]);
+            if (!VelocityStep1::get_profile(profiles[dof], p0s[dof], v0s[dof], a0s[dof], input.target_velocity[dof], input.target_acceleration[dof], input.max_acceleration[dof], input.max_jerk[dof])) {
+                result.result = Result::ErrorExecutionTimeCalculation;
+                return;
+            }
+            tfs[dof] = profiles[dof].duration();
+
+            BlockedInterval interval;
+            blocks[dof].size = 0;
+            if (VelocityStep1::get_blocked_interval(profiles[dof].t_sum[6], v0s[dof], a0s[dof], input.target_velocity[dof], input.target_acceleration[dof], input.max_acceleration[dof], input.max_jerk[dof], interval)) {
+                const double t_brake = profiles[dof].t_brake.value_or(0.0);
+                blocks[dof].intervals[0] = BlockedInterval {interval.left + t_brake, interval.right + t_brake};
+                blocks[dof].size = 1;
+            }
+            return;
+        }
+
+        std::tie(p0s[dof], v0s[dof], a0s[dof]) = profiles[dof].set_brake(input.current_position[dof], input.current_velocity[dof], input.current_acceleration[dof], input.max_velocity[dof], input.max_acceleration[dof], input.max_jerk[dof]);
+        pfs[dof] = input.target_position[dof];
+        vfs[dof] = input.target_velocity[dof];
+
+        const auto step1_start = statistics ? std::chrono::high_resolution_clock::now() : std::chrono::high_resolution_clock::time_point {};
+        bool found_profile = get_time_optimal_profile(profiles[dof], dof, p0s[dof], v0s[dof], a0s[dof], pfs[dof], vfs[dof], input.max_velocity[dof], input.max_acceleration[dof], input.max_jerk[dof]);
+
+        // E.g. a low jerk limit might not allow to stay within the velocity limit after the brake trajectory. Then fall back to
+        // the numeric search of the time synchronization, the found duration is valid, but not guaranteed to be time-optimal.
+        if (!found_profile) {
+            double t_profile {0.0};
+            found_profile = RuckigStep2::get_next_duration(profiles[dof], t_profile, p0s[dof], v0s[dof], a0s[dof], pfs[dof], vfs[dof], input.max_velocity[dof], input.max_acceleration[dof], input.max_jerk[dof], deadline);
+            result.is_fallback = true;
+        }
+
+        if (!found_profile) {
+            result.result = RuckigStep2::is_past(deadline) ? Result::ErrorCalculationTimeout : Result::ErrorExecutionTimeCalculation;
+            return;
+        }
+
+        if (statistics) {
+            auto step1_stop = std::chrono::high_resolution_clock::now();
+            result.step1_duration = std::chrono::duration_cast<std::chrono::nanoseconds>(step1_stop - step1_start).count() / 1000.0;
+        }
+        tfs[dof] = profiles[dof].duration();
+
+        // The velocity interface has only closed-form profiles in Step 1, so that e.g. braking isn't limited by the budget
+        if (RuckigStep2::is_past(deadline)) {
+            result.result = Result::ErrorCalculationTimeout;
+        }
+    }
+
+    //! Step 2 of a single DoF for the duration tf. Only the storage of this DoF is written, so that the DoFs can be calculated in parallel.
+    void calculate_step2(const InputParameter<DOFs>& input, StandardVector<Profile, DOFs>& profiles, size_t dof, double tf, size_t limiting_dof, bool allow_next_duration, RuckigStep2::Deadline deadline) {
+        DofResult& result = dof_results[dof];
+        result = DofResult {};
+        if (!input.enabled[dof] || dof == limiting_dof) {
+            return;
+        }
+
+        if (RuckigStep2::is_past(deadline)) {
+            result.result = Result::ErrorCalculationTimeout;
+            return;
+        }
+
+        double t_profile = tf - profiles[dof].t_brake.value_or(0.0);
+
+        if (input.type == InputParameter<DOFs>::Type::Velocity) {
+            if (!VelocityStep2::get_profile(profiles[dof], t_profile, p0s[dof], v0s[dof], a0s[dof], input.target_velocity[dof], input.target_acceleration[dof], input.max_acceleration[dof], input.max_jerk[dof])) {
+                result.result = Result::ErrorSynchronizationCalculation;
+            }
+            return;
+        }
+
+        const Profile old_profile = profiles[dof]; // Save profile to reset without time synchronization
+        if (RuckigStep2::get_profile(profiles[dof], t_profile, p0s[dof], v0s[dof], a0s[dof], pfs[dof], vfs[dof], input.max_velocity[dof], input.max_acceleration[dof], input.max_jerk[dof], deadline)) {
+            return;
+        }
+
+        // E.g. for a non-zero target velocity, tf might be within a blocked interval of this DoF. Then continue with its end,
+        // a profile from the cache didn't search the blocked intervals.
+        profiles[dof] = old_profile;
+        if (allow_next_duration && use_profile_cache) {
+            Profile profile = old_profile;
+            RuckigStep1::get_profile(profile, blocks[dof], p0s[dof], v0s[dof], a0s[dof], pfs[dof], vfs[dof], input.max_velocity[dof], input.max_acceleration[dof], input.max_jerk[dof]);
+        }
+
+        const BlockedInterval* interval = blocks[dof].find(tf);
+        if (allow_next_duration && interval && interval->right_profile) {
+            profiles[dof] = interval->right_profile.value();
+            result.is_fallback = true;
+            return;
+        }
+
+        result.result = RuckigStep2::is_past(deadline) ? Result::ErrorCalculationTimeout : Result::ErrorSynchronizationCalculation;
+    }
+
+    //! Round the duration up to a multiple of delta_time. Returns true if the duration was changed, so that all DoFs need to be synchronized again.
+    bool discretize_duration(double& tf) const {
+        const double tf_discrete = delta_time * std::ceil((tf - time_precision) / delta_time);
+        if (tf_discrete <= tf) {
             return false;
         }
 
-        if ((input.target_acceleration.array() != 0.0).any()) {
-            std::cerr << "Ruckig does not support a target acceleration." << std::endl;
+        tf = tf_discrete;
+        return true;
+    }
+
+    //! Returns the first DoF with invalid limits or targets, or degrees_of_freedom if the input is valid
+    size_t find_invalid_dof(const InputParameter<DOFs>& input) const {
+        const bool is_velocity_interface = (input.type == InputParameter<DOFs>::Type::Velocity);
+        for (size_t dof = 0; dof < degrees_of_freedom; dof += 1) {
+            if (input.max_acceleration[dof] <= 0.0 || input.max_jerk[dof] <= 0.0 || std::abs(input.target_acceleration[dof]) > input.max_acceleration[dof]) {
+                return dof;
+            }
+
+            // The closed-form profiles of the position interface end with zero acceleration
+            if (!is_velocity_interface && (input.max_velocity[dof] <= 0.0 || std::abs(input.target_velocity[dof]) > input.max_velocity[dof] || input.target_acceleration[dof] != 0.0)) {
+                return dof;
+            }
+        }
+        return degrees_of_freedom;
+    }
+
+    //! Step 1 of a single DoF with the configured search, the blocked intervals of the DoF are set as well
+    bool get_time_optimal_profile(Profile& profile, size_t dof, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
+        if (use_profile_cache) {
+            return RuckigStep1::get_profile(profile, blocks[dof], profile_caches[dof], p0, v0, a0, pf, vf, vMax, aMax, jMax);
+        }
+        return RuckigStep1::get_profile(profile, blocks[dof], p0, v0, a0, pf, vf, vMax, aMax, jMax);
+    }
+
+    //! All DoFs follow the normalized profile of the DoF with the largest distance, or with the largest velocity change for the velocity
+    //! interface. Returns false if the input is not collinear or no such profile was found before the deadline.
+    bool calculate_phase_synchronized(const InputParameter<DOFs>& input, StandardVector<Profile, DOFs>& profiles, double& tf, RuckigStep2::Deadline deadline) {
+        const bool is_velocity_interface = (input.type == InputParameter<DOFs>::Type::Velocity);
+        auto distance = [&](size_t dof) {
+            return is_velocity_interface ? input.target_velocity[dof] - input.current_velocity[dof] : input.target_position[dof] - input.current_position[dof];
+        };
+
+        size_t reference_dof {degrees_of_freedom};
+        for (size_t dof = 0; dof < degrees_of_freedom; dof += 1) {
+            if (input.enabled[dof] && (reference_dof == degrees_of_freedom || std::abs(distance(dof)) > std::abs(distance(reference_dof)))) {
+                reference_dof = dof;
+            }
+        }
+
+        if (reference_dof == degrees_of_freedom || distance(reference_dof) == 0.0) {
             return false;
         }
 
+        // Check collinearity relative to the magnitude of the reference DoF, and combine the limits of all DoFs for the reference DoF
+        const double tolerance = 1e-8 * std::max({std::abs(distance(reference_dof)), std::abs(input.current_velocity[reference_dof]), std::abs(input.current_acceleration[reference_dof]), std::abs(input.target_velocity[reference_dof]), std::abs(input.target_acceleration[reference_dof])});
+        double vMax {std::numeric_limits<double>::infinity()};
+        double aMax {std::numeric_limits<double>::infinity()};
+        double jMax {std::numeric_limits<double>::infinity()};
+        for (size_t dof = 0; dof < degrees_of_freedom; dof += 1) {
+            if (!input.enabled[dof]) {
+                continue;
+            }
+
+            const double scale = distance(dof) / distance(reference_dof);
+            if (std::abs(input.current_velocity[dof] - scale * input.current_velocity[reference_dof]) > tolerance
+                || std::abs(input.current_acceleration[dof] - scale * input.current_acceleration[reference_dof]) > tolerance
+                || std::abs(input.target_velocity[dof] - scale * input.target_velocity[reference_dof]) > tolerance
+                || std::abs(input.target_acceleration[dof] - scale * input.target_acceleration[reference_dof]) > tolerance) {
+                return false;
+            }
+
+            scales[dof] = scale;
+            if (scale != 0.0) {
+                if (!is_velocity_interface) {
+                    vMax = std::min(vMax, input.max_velocity[dof] / std::abs(scale));
+                }
+                aMax = std::min(aMax, input.max_acceleration[dof] / std::abs(scale));
+                jMax = std::min(jMax, input.max_jerk[dof] / std::abs(scale));
+            }
+        }
+
+        Profile& reference = profiles[reference_dof];
+        double p0, v0, a0, pf {0.0}, vf {0.0};
+        std::tie(p0, v0, a0) = reference.set_brake(input.current_position[reference_dof], input.current_velocity[reference_dof], input.current_acceleration[reference_dof], vMax, aMax, jMax);
+
+        // The velocity interface reaches the target acceleration within its profile. Within a blocked interval, continue with its end.
+        auto get_profile = [&](double t_profile) {
+            if (is_velocity_interface) {
+                return VelocityStep2::get_profile(reference, t_profile, p0, v0, a0, input.target_velocity[reference_dof], input.target_acceleration[reference_dof], aMax, jMax);
+            }
+
+            const Profile old_reference = reference;
+            if (RuckigStep2::get_profile(reference, t_profile, p0, v0, a0, pf, vf, vMax, aMax, jMax, deadline)) {
+                return true;
+            }
+
+            const BlockedInterval* interval = blocks[reference_dof].find(t_profile + reference.t_brake.value_or(0.0));
+            reference = (interval && interval->right_profile) ? interval->right_profile.value() : old_reference;
+            return (interval && interval->right_profile);
+        };
+
+        if (is_velocity_interface) {
+            if (!VelocityStep1::get_profile(reference, p0, v0, a0, input.target_velocity[reference_dof], input.target_acceleration[reference_dof], aMax, jMax)) {
+                return false;
+            }
+
+        } else {
+            pf = input.target_position[reference_dof];
+            vf = input.target_velocity[reference_dof];
+            if (std::abs(vf) > vMax) {
+                return false;
+            }
+
+            // The blocked intervals of the combined limits, without a possibly incomplete block of the cache
+            double t_profile {0.0};
+            const bool found_profile = RuckigStep1::get_profile(reference, blocks[reference_dof], p0, v0, a0, pf, vf, vMax, aMax, jMax);
+            if (!found_profile && !RuckigStep2::get_next_duration(reference, t_profile, p0, v0, a0, pf, vf, vMax, aMax, jMax, deadline)) {
+                return false;
+            }
+        }
+
+        // Stretch to the minimum duration and to a multiple of the control cycle
+        const bool is_discrete = (input.duration_discretization == InputParameter<DOFs>::DurationDiscretization::Discrete);
+        double tf_reference = reference.duration();
         if (input.minimum_duration.has_value()) {
-            std::cerr << "Ruckig does not support a minimum duration." << std::endl;
+            tf_reference = std::max(tf_reference, input.minimum_duration.value());
+        }
+        if (is_discrete) {
+            discretize_duration(tf_reference);
+        }
+
+        if (tf_reference > reference.duration() && !get_profile(tf_reference - reference.t_brake.value_or(0.0))) {
             return false;
         }
 
-        auto start = std::chrono::high_resolution_clock::now();
+        // The next reachable duration might not be a multiple of the control cycle, then fall back to time synchronization
+        tf_reference = reference.duration();
+        if (is_discrete && discretize_duration(tf_reference)) {
+            return false;
+        }
 
-        // Calculate brakes (if input exceeds or will exceed limits)
-        for (size_t dof = 0; dof < DOFs; dof += 1) {
-            if (!input.enabled[dof]) {
-                continue;
+        tf = reference.duration();
+        for (size_t dof = 0; dof < degrees_of_freedom; dof += 1) {
+            if (input.enabled[dof] && dof != reference_dof) {
+                profiles[dof] = reference.scale(scales[dof], input.current_position[dof], input.current_position[reference_dof]);
+            }
+        }
+
+        // Each moving DoF brakes with the scaled profile of the reference DoF
+        if (statistics && reference.t_brake.value_or(0.0) > 0.0) {
+            for (size_t dof = 0; dof < degrees_of_freedom; dof += 1) {
+                if (input.enabled[dof] && scales[dof] != 0.0) {
+                    statistics->record_brake();
+                }
             }
+        }
+        return true;
+    }
+
+public:
+    //! Tolerance of the accumulated time steps, e.g. when checking if a trajectory with a discrete duration is finished
+    static constexpr double time_precision {1e-9};
+
+    //! Number of DoFs, either DOFs or set at runtime for DOFs = 0
+    const size_t degrees_of_freedom;
+
+    //! Time step between updates (cycle time) in [s]
+    const double delta_time;
+
+    //! Time for calculating the last full trajectory in [µs]
+    double last_calculation_duration {-1};
 
-            RuckigStep1::get_brake_trajectory(input.current_velocity[dof], input.current_acceleration[dof], input.max_velocity[dof], input.max_acceleration[dof], input.max_jerk[dof], profiles[dof].t_brakes, profiles[dof].j_brakes);
-            profiles[dof].t_brake = profiles[dof].t_brakes[0] + profiles[dof].t_brakes[1];
+    /**
+     * Optional computation budget of a calculation in [µs], checked after each DoF of Step 1 and Step 2. If an update exceeds the budget,
+     * it keeps following the previous trajectory (or brakes if there is none) and retries in the next cycle. Other errors are returned immediately.
+     */
+    std::optional<double> calculation_budget;
 
-            // std::cout << dof << ": " << t_brakes_[dof][0] << " " << t_brakes_[dof][1] << std::endl;
+    /**
+     * Try the recently found profile types of each DoF first, e.g. for continuous re-targeting. Opt-in, as the trajectory then depends
+     * on the calculation history: a cached type might give another valid profile than the ordered search, so that two instances disagree.
+     */
+    bool use_profile_cache {false};
+
+    //! Recently found profile types and hit rates of each DoF
+    StandardVector<ProfileCache, DOFs> profile_caches;
+
+    //! Optional runtime statistics, e.g. shared with a monitoring thread. Disabled if null.
+    std::shared_ptr<RuckigStatistics> statistics;
+
+    //! Optional pool to calculate Step 1 and Step 2 of the DoFs in parallel, e.g. for many DoFs. Serial if null.
+    std::shared_ptr<WorkerPool> worker_pool;
+
+    template<size_t D = DOFs, std::enable_if_t<(D >= 1), int> = 0>
+    explicit Ruckig(double delta_time): degrees_of_freedom(DOFs), delta_time(delta_time) { }
+
+    //! All per-DoF storage is allocated once here, so that updates don't allocate
+    template<size_t D = DOFs, std::enable_if_t<(D == 0), int> = 0>
+    explicit Ruckig(size_t degrees_of_freedom, double delta_time):
+        current_input(degrees_of_freedom), stop_input(degrees_of_freedom), trajectory(degrees_of_freedom), next_trajectory(degrees_of_freedom),
+        tfs(degrees_of_freedom), p0s(degrees_of_freedom), v0s(degrees_of_freedom), a0s(degrees_of_freedom), pfs(degrees_of_freedom), vfs(degrees_of_freedom), blocks(degrees_of_freedom), scales(degrees_of_freedom), dof_results(degrees_of_freedom),
+        degrees_of_freedom(degrees_of_freedom), delta_time(delta_time), profile_caches(degrees_of_freedom) { }
+
+    /**
+     * Calculate a new trajectory for the given input, independent of the current state of the generator.
+     * Returns Working if a trajectory was found, otherwise the error, see get_error() for details.
+     */
+    Result calculate(const InputParameter<DOFs>& input, RuckigTrajectory<DOFs>& trajectory) {
+        const bool is_velocity_interface = (input.type == InputParameter<DOFs>::Type::Velocity);
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+
+        // Check input
+        if constexpr (DOFs == 0) {
+            if (input.get_degrees_of_freedom() != degrees_of_freedom || trajectory.get_degrees_of_freedom() != degrees_of_freedom) {
+                return set_error(Result::ErrorInvalidInput, 0, nan, nan, nan, nan, nan, nan, nan, nan, nan);
+            }
         }
 
-        std::array<double, DOFs> tfs; // Profile duration
-        std::array<double, DOFs> p0s, v0s, a0s; // Starting point of profiles without brake trajectory
-        for (size_t dof = 0; dof < DOFs; dof += 1) {
-            if (!input.enabled[dof]) {
-                tfs[dof] = 0.0;
-                continue;
+        const size_t invalid_dof = find_invalid_dof(input);
+        if (invalid_dof < degrees_of_freedom) {
+            const size_t dof = invalid_dof;
+            return set_error(Result::ErrorInvalidInput, dof, input.current_position[dof], input.current_velocity[dof], input.current_acceleration[dof], is_velocity_interface ? nan : input.target_position[dof], input.target_velocity[dof], input.target_acceleration[dof], is_velocity_interface ? nan : input.max_velocity[dof], input.max_acceleration[dof], input.max_jerk[dof]);
+        }
+
+        auto start = std::chrono::high_resolution_clock::now();
+        const RuckigStep2::Deadline deadline = get_deadline(start);
+
+        auto& profiles = trajectory.profiles;
+        trajectory.enabled = input.enabled;
+        trajectory.initial_position = input.current_position;
+        trajectory.initial_velocity = input.current_velocity;
+        trajectory.initial_acceleration = input.current_acceleration;
+
+        if (input.synchronization == InputParameter<DOFs>::Synchronization::Phase) {
+            double tf;
+            if (calculate_phase_synchronized(input, profiles, tf, deadline)) {
+                trajectory.duration = tf;
+                trajectory.set_segments();
+
+                auto stop = std::chrono::high_resolution_clock::now();
+                last_calculation_duration = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count() / 1000.0;
+                if (statistics) {
+                    statistics->record_calculation(last_calculation_duration);
+                }
+                return Result::Working;
             }
 
-            p0s[dof] = input.current_position[dof];
-            v0s[dof] = input.current_velocity[dof];
-            a0s[dof] = input.current_acceleration[dof];
+            // Otherwise fall back to time synchronization, if the budget allows
+            if (RuckigStep2::is_past(deadline)) {
+                return set_error(Result::ErrorCalculationTimeout, 0, input);
+            }
+        }
 
-            if (profiles[dof].t_brakes[0] > 0.0) {
-                profiles[dof].p_brakes[0] = p0s[dof];
-                profiles[dof].v_brakes[0] = v0s[dof];
-                profiles[dof].a_brakes[0] = a0s[dof];
-                std::tie(p0s[dof], v0s[dof], a0s[dof]) = Profile::integrate(profiles[dof].t_brakes[0], p0s[dof], v0s[dof], a0s[dof], profiles[dof].j_brakes[0]);
+        for_each_dof([&](size_t dof) {
+            calculate_step1(input, profiles, dof, deadline);
+            return dof_results[dof].result == Result::Working;
+        });
 
-                if (profiles[dof].t_brakes[1] > 0.0) {
-                    profiles[dof].p_brakes[1] = p0s[dof];
-                    profiles[dof].v_brakes[1] = v0s[dof];
-                    profiles[dof].a_brakes[1] = a0s[dof];
-                    std::tie(p0s[dof], v0s[dof], a0s[dof]) = Profile::integrate(profiles[dof].t_brakes[1], p0s[dof], v0s[dof], a0s[dof], profiles[dof].j_brakes[1]);
+        // Record the statistics and find the first error in the order of the DoFs, independent of the parallel calculation
+        for (size_t dof = 0; dof < degrees_of_freedom; dof += 1) {
+            if (!input.enabled[dof]) {
+                continue;
+            }
+
+            const DofResult& result = dof_results[dof];
+            if (statistics) {
+                if (profiles[dof].t_brake.value_or(0.0) > 0.0) {
+                    statistics->record_brake();
+                }
+                if (result.is_fallback) {
+                    statistics->record_step1_fallback();
+                }
+                if (result.step1_duration >= 0.0) {
+                    statistics->record_step1(profiles[dof].type, result.step1_duration);
                 }
             }
 
-            bool found_profile = RuckigStep1::get_profile(profiles[dof], p0s[dof], v0s[dof], a0s[dof], input.target_position[dof], input.target_velocity[dof], input.max_velocity[dof], input.max_acceleration[dof], input.max_jerk[dof]);
-            if (!found_profile) {
-                throw std::runtime_error("Error in Step 1 while calculating an online trajectory for: "
-                    + std::to_string(input.current_position[dof]) + ", " + std::to_string(input.current_velocity[dof]) + ", " + std::to_string(input.current_acceleration[dof])
-                    + " targets: " + std::to_string(input.target_position[dof])
-                    + " limits: " + std::to_string(input.max_velocity[dof]) + ", " + std::to_string(input.max_acceleration[dof]) + ", " + std::to_string(input.max_jerk[dof])
-                    + " profile input: " + std::to_string(p0s[dof]) + ", " + std::to_string(v0s[dof]) + ", " + std::to_string(a0s[dof])
-                );
+            if (result.result != Result::Working) {
+                return set_error(result.result, dof, input);
             }
-            tfs[dof] = profiles[dof].t_sum[6] + profiles[dof].t_brake.value_or(0.0);
         }
 
         auto tf_max_pointer = std::max_element(tfs.begin(), tfs.end());
         size_t limiting_dof = std::distance(tfs.begin(), tf_max_pointer);
-        tf = *tf_max_pointer;
+        double tf = *tf_max_pointer;
 
-        if (tf > 0.0) {
-            for (size_t dof = 0; dof < DOFs; dof += 1) {
-                if (!input.enabled[dof] || dof == limiting_dof) {
-                    continue;
+        // Stretch all DoFs to the minimum duration
+        if (input.minimum_duration.has_value() && input.minimum_duration.value() > tf) {
+            tf = input.minimum_duration.value();
+            limiting_dof = degrees_of_freedom;
+        }
+
+        // Stretch all DoFs to the next multiple of the control cycle
+        const bool is_discrete = (input.duration_discretization == InputParameter<DOFs>::DurationDiscretization::Discrete);
+        if (is_discrete && discretize_duration(tf)) {
+            limiting_dof = degrees_of_freedom;
+        }
+
+        // Without synchronization, each DoF keeps its time-optimal profile and the trajectory ends with the slowest DoF
+        const bool is_independent = (input.synchronization == InputParameter<DOFs>::Synchronization::None);
+
+        // Skip durations that some DoFs can't reach. The DoF of the known profile at the end of the blocked interval limits the duration.
+        if (!is_independent) {
+            bool is_blocked {true};
+            while (is_blocked) {
+                is_blocked = false;
+                for (size_t dof = 0; dof < degrees_of_freedom; dof += 1) {
+                    const BlockedInterval* interval = input.enabled[dof] ? blocks[dof].find(tf) : nullptr;
+                    if (!interval) {
+                        continue;
+                    }
+
+                    tf = interval->right;
+                    limiting_dof = degrees_of_freedom;
+                    is_blocked = true;
+                    if (interval->right_profile) {
+                        profiles[dof] = interval->right_profile.value();
+                        limiting_dof = dof;
+                    }
+                    if (is_discrete && discretize_duration(tf)) {
+                        limiting_dof = degrees_of_freedom;
+                    }
+                }
+            }
+        }
+
+        // If a DoF can't reach its target in tf, continue with the next reachable duration of that DoF
+        size_t synchronization_attempts {0};
+        bool is_synchronized {is_independent};
+        while (tf > 0.0 && !is_synchronized) {
+            is_synchronized = true;
+            const bool allow_next_duration = (synchronization_attempts < 2 * degrees_of_freedom);
+            for_each_dof([&](size_t dof) {
+                calculate_step2(input, profiles, dof, tf, limiting_dof, allow_next_duration, deadline);
+                return dof_results[dof].result == Result::Working && !dof_results[dof].is_fallback;
+            });
+
+            for (size_t dof = 0; dof < degrees_of_freedom; dof += 1) {
+                const DofResult& result = dof_results[dof];
+                if (result.is_fallback) {
+                    tf = profiles[dof].duration();
+                    limiting_dof = dof;
+                    if (is_discrete && discretize_duration(tf)) {
+                        limiting_dof = degrees_of_freedom;
+                    }
+                    synchronization_attempts += 1;
+                    is_synchronized = false;
+                    if (statistics) {
+                        statistics->record_step2_fallback();
+                    }
+                    break;
                 }
 
-                double t_profile = tf - profiles[dof].t_brake.value_or(0.0);
-
-                const Profile old_profile = profiles[dof]; // Save profile to reset without time synchronization
-                bool found_time_synchronization = RuckigStep2::get_profile(profiles[dof], t_profile, p0s[dof], v0s[dof], a0s[dof], input.target_position[dof], input.target_velocity[dof], input.max_velocity[dof], input.max_acceleration[dof], input.max_jerk[dof]);
-                
-                // Currently only for target velocity == 0, should be an error otherwise.
-                if (!found_time_synchronization) {
-                    profiles[dof] = old_profile;
-                    throw std::runtime_error("Error in Step 2 while calculating an online trajectory for: "
-                        + std::to_string(input.current_position[dof]) + ", " + std::to_string(input.current_velocity[dof]) + ", " + std::to_string(input.current_acceleration[dof])
-                        + " targets: " + std::to_string(input.target_position[dof])
-                        + " limits: " + std::to_string(input.max_velocity[dof]) + ", " + std::to_string(input.max_acceleration[dof]) + ", " + std::to_string(input.max_jerk[dof])
-                        + " profile input: " + std::to_string(p0s[dof]) + ", " + std::to_string(v0s[dof]) + ", " + std::to_string(a0s[dof])
-                    );
+                if (result.result != Result::Working) {
+                    return set_error(result.result, dof, input);
                 }
             }
         }
 
+        trajectory.duration = tf;
+        trajectory.set_segments();
+
         auto stop = std::chrono::high_resolution_clock::now();
         last_calculation_duration = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count() / 1000.0;
-
-        t = 0.0;
-        output.duration = tf;
-        return true;
+        if (statistics) {
+            statistics->record_calculation(last_calculation_duration);
+        }
+        return Result::Working;
     }
 
-public:
-    //! Time step between updates (cycle time) in [s]
-    const double delta_time;
+    /**
+     * Calculate a time-optimal stop to zero velocity and acceleration from the current state of the input, e.g. for a stop reaction
+     * within the same control cycle. Each DoF brakes independently with its acceleration and jerk limit, all other fields of the input
+     * are ignored. In contrast to calculate() with a stop input, there is no synchronization and the cost per DoF is constant.
+     */
+    Result calculate_stop(const InputParameter<DOFs>& input, RuckigTrajectory<DOFs>& trajectory) {
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+        if constexpr (DOFs == 0) {
+            if (input.get_degrees_of_freedom() != degrees_of_freedom || trajectory.get_degrees_of_freedom() != degrees_of_freedom) {
+                return set_error(Result::ErrorInvalidInput, 0, nan, nan, nan, nan, nan, nan, nan, nan, nan);
+            }
+        }
 
-    //! Time for calculating the last full trajectory in [µs]
-    double last_calculation_duration {-1};
+        auto start = std::chrono::high_resolution_clock::now();
 
-    explicit Ruckig(double delta_time): delta_time(delta_time) { }
+        auto& profiles = trajectory.profiles;
+        trajectory.enabled = input.enabled;
+        trajectory.initial_position = input.current_position;
+        trajectory.initial_velocity = input.current_velocity;
+        trajectory.initial_acceleration = input.current_acceleration;
+        trajectory.duration = 0.0;
+
+        for (size_t dof = 0; dof < degrees_of_freedom; dof += 1) {
+            if (!input.enabled[dof]) {
+                continue;
+            }
+
+            const double aMax = input.max_acceleration[dof];
+            const double jMax = input.max_jerk[dof];
+            if (aMax <= 0.0 || jMax <= 0.0) {
+                return set_error(Result::ErrorInvalidInput, dof, input.current_position[dof], input.current_velocity[dof], input.current_acceleration[dof], nan, 0.0, 0.0, nan, aMax, jMax);
+            }
+
+            // The brake trajectory reaches the acceleration limit, from which the velocity profile to standstill is closed-form
+            std::tie(p0s[dof], v0s[dof], a0s[dof]) = profiles[dof].set_brake(input.current_position[dof], input.current_velocity[dof], input.current_acceleration[dof], std::numeric_limits<double>::infinity(), aMax, jMax);
+            if (!VelocityStep1::get_profile(profiles[dof], p0s[dof], v0s[dof], a0s[dof], 0.0, 0.0, aMax, jMax)) {
+                return set_error(Result::ErrorExecutionTimeCalculation, dof, p0s[dof], v0s[dof], a0s[dof], nan, 0.0, 0.0, nan, aMax, jMax);
+            }
+            trajectory.duration = std::max(trajectory.duration, profiles[dof].duration());
+        }
+
+        trajectory.set_segments();
+
+        auto stop = std::chrono::high_resolution_clock::now();
+        last_calculation_duration = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count() / 1000.0;
+        if (statistics) {
+            statistics->record_calculation(last_calculation_duration);
+        }
+        return Result::Working;
+    }
 
     Result update(const InputParameter<DOFs>& input, OutputParameter<DOFs>& output) {
         t += delta_time;
 
-        if (input != current_input && !calculate(input, output)) {
-            return Result::Error;
+        bool is_retrying {false};
+        if (input.has_changed(current_input)) {
+            const Result result = calculate(input, output);
+            if (result != Result::Working) {
+                // Only a timeout keeps following the previous trajectory (or brakes if there is none) and retries in the next cycle
+                if (result != Result::ErrorCalculationTimeout || (!has_trajectory && !calculate_stop(input, output))) {
+                    return result;
+                }
+                is_retrying = true;
+            }
         }
 
-        atTime(t, output);
-        if (t + delta_time > tf) {
-            return Result::Finished;
+        const bool is_finished = (t + delta_time > trajectory.duration + time_precision);
+        if (is_finished) {
+            atTime(t, output);
+        } else {
+            cursor.at_time(trajectory, t, output.new_position, output.new_velocity, output.new_acceleration);
         }
 
+        // A fed-back output is the same state, so that it doesn't change the input
         current_input.current_position = output.new_position;
         current_input.current_velocity = output.new_velocity;
         current_input.current_acceleration = output.new_acceleration;
-        return Result::Working;
+        return (is_finished && !is_retrying) ? Result::Finished : Result::Working;
     }
 
     void atTime(double time, OutputParameter<DOFs>& output) {
-        if (time + delta_time > tf) {
+        // The velocity interface has no target position, so the trajectory continues with the target velocity
+        if (time + delta_time > trajectory.duration + time_precision && current_input.type == InputParameter<DOFs>::Type::Position) {
             output.new_position = current_input.target_position;
             output.new_velocity = current_input.target_velocity;
             output.new_acceleration = current_input.target_acceleration;
             return;
         }
 
-        for (size_t dof = 0; dof < DOFs; dof += 1) {
-            if (!current_input.enabled[dof]) {
-                output.new_acceleration[dof] = current_input.current_acceleration[dof];
-                output.new_velocity[dof] = current_input.current_velocity[dof];
-                output.new_position[dof] = current_input.current_position[dof];
-            }
-
-            auto& p = profiles[dof];
-
-            double t_diff = time;
-            if (p.t_brake.has_value()) {
-                if (t_diff < p.t_brake.value()) {
-                    size_t index = (t_diff < p.t_brakes[0]) ? 0 : 1;
-                    if (index > 0) {
-                        t_diff -= p.t_brakes[index - 1];
-                    }
-
-                    std::tie(output.new_position[dof], output.new_velocity[dof], output.new_acceleration[dof]) = Profile::integrate(t_diff, p.p_brakes[index], p.v_brakes[index], p.a_brakes[index], p.j_brakes[index]);
-                    continue;
-                } else {
-                    t_diff -= p.t_brake.value();
-                }
-            }
-
-            if (t_diff >= p.t_sum[6]) {
-                output.new_position[dof] = p.p[7];
-                output.new_velocity[dof] = p.v[7];
-                output.new_acceleration[dof] = p.a[7];
-                continue;
-            }
+        trajectory.at_time(time, output.new_position, output.new_velocity, output.new_acceleration);
+    }
 
-            auto index_ptr = std::upper_bound(p.t_sum.begin(), p.t_sum.end(), t_diff);
-            size_t index = std::distance(p.t_sum.begin(), index_ptr);
+    //! Sample the last calculated trajectory at the times t0 + i dt into buffers with a row per sample and a column per DoF
+    void sample(double t0, double dt, Eigen::Ref<Eigen::MatrixXd> positions, Eigen::Ref<Eigen::MatrixXd> velocities, Eigen::Ref<Eigen::MatrixXd> accelerations) const {
+        trajectory.sample(t0, dt, positions, velocities, accelerations);
+    }
 
-            if (index > 0) {
-                t_diff -= p.t_sum[index - 1];
-            }
+    //! The last calculated trajectory
+    const RuckigTrajectory<DOFs>& get_trajectory() const {
+        return trajectory;
+    }
 
-            std::tie(output.new_position[dof], output.new_velocity[dof], output.new_acceleration[dof]) = Profile::integrate(t_diff, p.p[index], p.v[index], p.a[index], p.j[index]);
-        }
+    //! Details about the last failed calculation
+    const CalculationError& get_error() const {
+        return error;
     }
 };
 
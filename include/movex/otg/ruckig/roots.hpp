@@ -1,13 +1,66 @@
 #pragma once
 
 #define _USE_MATH_DEFINES
+#include <algorithm>
+#include <array>
 #include <cfloat>
 #include <cmath>
-#include <set>
 
 
 namespace Roots {
 
+// Fixed-capacity set of sorted and unique values, e.g. roots of a polynomial
+// Lives on the stack, so that no heap allocation happens in the real-time control loop
+template<typename T, size_t N>
+class Set {
+    std::array<T, N> data;
+    size_t length {0};
+
+public:
+    Set() {}
+
+    template<size_t M>
+    Set(const Set<T, M>& other) {
+        static_assert(M <= N, "Set capacity is too small.");
+        for (const T& value: other) {
+            insert(value);
+        }
+    }
+
+    // Inserts the value at its sorted position, ignores duplicates and values exceeding the capacity
+    void insert(const T& value) {
+        size_t index = 0;
+        while (index < length && data[index] < value) {
+            ++index;
+        }
+        if ((index < length && !(value < data[index])) || length == N) {
+            return;
+        }
+
+        for (size_t i = length; i > index; --i) {
+            data[i] = data[i - 1];
+        }
+        data[index] = value;
+        ++length;
+    }
+
+    size_t size() const {
+        return length;
+    }
+
+    bool empty() const {
+        return length == 0;
+    }
+
+    const T* begin() const {
+        return data.data();
+    }
+
+    const T* end() const {
+        return data.data() + length;
+    }
+};
+
 inline double polyEval(double *p, int len, double x) {
     double retVal = 0.0;
 
@@ -32,8 +85,8 @@ inline double polyEval(double *p, int len, double x) {
 }
 
 // Calculate all roots of a*x^3 + b*x^2 + c*x + d = 0
-inline std::set<double> solveCub(double a, double b, double c, double d) {
-    std::set<double> roots;
+inline Set<double, 3> solveCub(double a, double b, double c, double d) {
+    Set<double, 3> roots;
 
     constexpr double cos120 = -0.50;
     constexpr double sin120 = 0.866025403784438646764;
@@ -57,13 +110,16 @@ inline std::set<double> solveCub(double a, double b, double c, double d) {
             }
         
         } else {
-            // Quadratic equation
+            // Quadratic equation, without cancellation for a small b (see Numerical Recipes 5.6)
             double discriminant = c * c - 4.0 * b * d;
             if (discriminant >= 0) {
-                double inv2b = 1.0 / (2.0 * b);
-                double y = sqrt(discriminant);
-                roots.insert((-c + y) * inv2b);
-                roots.insert((-c - y) * inv2b);
+                double q = -0.5 * (c + std::copysign(sqrt(discriminant), c));
+                if (q == 0.0) {
+                    roots.insert(0.0);
+                } else {
+                    roots.insert(q / b);
+                    roots.insert(d / q);
+                }
             }
         }
 
@@ -174,8 +230,8 @@ inline int solveResolvent(double *x, double a, double b, double c) {
 
 // Calculate all roots of the monic quartic equation:
 // x^4 + a*x^3 + b*x^2 + c*x +d = 0
-inline std::set<double> solveQuartMonic(double a, double b, double c, double d) {
-    std::set<double> roots;
+inline Set<double, 4> solveQuartMonic(double a, double b, double c, double d) {
+    Set<double, 4> roots;
 
     double a3 = -b;
     double b3 = a * c - 4.0 * d;
@@ -246,14 +302,14 @@ inline std::set<double> solveQuartMonic(double a, double b, double c, double d)
 
 // Calculate the quartic equation: a*x^4 + b*x^3 + c*x^2 + d*x + e = 0
 // All coefficients can be zero
-inline std::set<double> solveQuart(double a, double b, double c, double d, double e) {
+inline Set<double, 4> solveQuart(double a, double b, double c, double d, double e) {
     if (fabs(a) < DBL_EPSILON) {
         return solveCub(b, c, d, e);
     }
     return solveQuartMonic(b / a, c / a, d / a, e / a);
 }
 
-inline std::set<double> solveQuart(const std::array<double, 5>& polynom) {
+inline Set<double, 4> solveQuart(const std::array<double, 5>& polynom) {
     return solveQuart(polynom[0], polynom[1], polynom[2], polynom[3], polynom[4]);
 }
 
@@ -328,17 +384,53 @@ inline double safeNewton(const F &func, const DF &dfunc, const double &l, const
     return rts;
 }
 
+// Maximal number of coefficients for shrinkInterval (polynomial of 7th order)
+constexpr int maxShrinkCoeffs {8};
+
 // Calculate a single zero of poly coeffs(x) inside [lbound, ubound]
-// Requirements: coeffs(lbound)*coeffs(ubound) < 0, lbound < ubound
+// Requirements: coeffs(lbound)*coeffs(ubound) < 0, lbound < ubound, numCoeffs <= maxShrinkCoeffs
 inline double shrinkInterval(double *coeffs, int numCoeffs, double lbound, double ubound, double tol) {
-    double *dcoeffs = new double[numCoeffs - 1];
-    polyDeri(coeffs, dcoeffs, numCoeffs);
+    std::array<double, maxShrinkCoeffs - 1> dcoeffs;
+    polyDeri(coeffs, dcoeffs.data(), numCoeffs);
     auto func = [&coeffs, &numCoeffs](double x) { return polyEval(coeffs, numCoeffs, x); };
-    auto dfunc = [&dcoeffs, &numCoeffs](double x) { return polyEval(dcoeffs, numCoeffs - 1, x); };
+    auto dfunc = [&dcoeffs, &numCoeffs](double x) { return polyEval(dcoeffs.data(), numCoeffs - 1, x); };
     constexpr int maxDblIts = 128;
-    double rts = safeNewton(func, dfunc, lbound, ubound, tol, maxDblIts);
-    delete[] dcoeffs;
-    return rts;
+    return safeNewton(func, dfunc, lbound, ubound, tol, maxDblIts);
+}
+
+// Polish an approximate root x of the poly coeffs(x) with Newton steps and a bisection fallback (see safeNewton). The bracket around x
+// starts with a relative width of 1e-6, well above the usual error of the closed-form roots, and is widened by a factor of 10 up to 1e-2
+// until the poly changes its sign, e.g. for ill-conditioned roots of a nearly degenerate poly. Without a sign change, e.g. at a double root,
+// x is kept.
+template<size_t N>
+inline double polishRoot(const std::array<double, N>& coeffs, double x) {
+    constexpr double minPolishWidth {1e-6}, maxPolishWidth {1e-2};
+    constexpr double polishTolerance {1e-15};
+    constexpr int maxPolishIts {64};
+
+    std::array<double, N> polyCoeffs = coeffs;
+    auto func = [&polyCoeffs](double x) { return polyEval(polyCoeffs.data(), N, x); };
+
+    const double fx = func(x);
+    if (fx == 0.0) {
+        return x;
+    }
+
+    std::array<double, N - 1> dcoeffs;
+    polyDeri(polyCoeffs.data(), dcoeffs.data(), N);
+    auto dfunc = [&dcoeffs](double x) { return polyEval(dcoeffs.data(), N - 1, x); };
+
+    const double scale = std::max(std::abs(x), 1.0);
+    for (double width = minPolishWidth; width < 1.01 * maxPolishWidth; width *= 10) {
+        const double lower = x - width * scale, upper = x + width * scale;
+        if (func(lower) * fx <= 0.0) {
+            return safeNewton(func, dfunc, lower, x, polishTolerance, maxPolishIts);
+        }
+        if (func(upper) * fx <= 0.0) {
+            return safeNewton(func, dfunc, x, upper, polishTolerance, maxPolishIts);
+        }
+    }
+    return x;
 }
 
 } // namespace Roots
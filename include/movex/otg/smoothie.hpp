@@ -12,7 +12,7 @@ namespace movex {
  */
 template<size_t DOFs>
 class Smoothie {
-    using Vector = Eigen::Matrix<double, DOFs, 1, Eigen::ColMajor>;
+    using Vector = EigenVector<DOFs>;
 
     static constexpr double q_delta_motion_finished {1e-6};
 
@@ -26,15 +26,15 @@ class Smoothie {
 
     void calculateSynchronizedValues() {
         Vector dq_max_reach(dq_max_);
-        Vector t_f = Vector::Zero();
-        Vector delta_t_2 = Vector::Zero();
-        Vector t_1 = Vector::Zero();
-        Vector delta_t_2_sync = Vector::Zero();
+        Vector t_f = Vector::Zero(q_delta.size());
+        Vector delta_t_2 = Vector::Zero(q_delta.size());
+        Vector t_1 = Vector::Zero(q_delta.size());
+        Vector delta_t_2_sync = Vector::Zero(q_delta.size());
         Vector sign_delta_q = q_delta.cwiseSign();
 
         time = 0.0;
 
-        for (size_t i = 0; i < DOFs; i++) {
+        for (Eigen::Index i = 0; i < q_delta.size(); i++) {
             if (std::abs(q_delta[i]) > q_delta_motion_finished) {
                 if (std::abs(q_delta[i]) < (3.0 / 4.0 * (std::pow(dq_max_[i], 2.0) / ddq_max_initial[i]) + 3.0 / 4.0 * (std::pow(dq_max_[i], 2.0) / ddq_max_target[i]))) {
                     dq_max_reach[i] = std::sqrt(4.0 / 3.0 * q_delta[i] * sign_delta_q[i] * (ddq_max_initial[i] * ddq_max_target[i]) / (ddq_max_initial[i] + ddq_max_target[i]));
@@ -46,7 +46,7 @@ class Smoothie {
         }
 
         double max_t_f = t_f.maxCoeff();
-        for (size_t i = 0; i < DOFs; i++) {
+        for (Eigen::Index i = 0; i < q_delta.size(); i++) {
             if (std::abs(q_delta[i]) > q_delta_motion_finished) {
                 double a = 1.5 / 2.0 * (ddq_max_target[i] + ddq_max_initial[i]);
                 double b = -1.0 * max_t_f * ddq_max_target[i] * ddq_max_initial[i];
@@ -65,41 +65,61 @@ class Smoothie {
         }
     }
 
-    bool calculateDesiredValues(double t, Vector& q_delta_d) const {
+    //! Position relative to the initial one, velocity and acceleration at time t, the latter two are the derivatives of the position polynomials
+    bool calculateDesiredValues(double t, Vector& q_delta_d, Vector& dq_d, Vector& ddq_d) const {
         Vector sign_delta_q = q_delta.cwiseSign();
         Vector t_d = t_2_sync - t_1_sync;
         Vector delta_t_2_sync = t_f_sync - t_2_sync;
-        std::array<bool, DOFs> joint_motion_finished {};
+        bool motion_finished {true};
 
-        for (size_t i = 0; i < DOFs; i++) {
+        for (Eigen::Index i = 0; i < q_delta.size(); i++) {
             if (std::abs(q_delta[i]) < q_delta_motion_finished) {
                 q_delta_d[i] = 0;
-                joint_motion_finished[i] = true;
+                dq_d[i] = 0;
+                ddq_d[i] = 0;
             } else {
                 if (t < t_1_sync[i]) {
-                    q_delta_d[i] = -1.0 / std::pow(t_1_sync[i], 3.0) * dq_max_sync_[i] * sign_delta_q[i] * (0.5 * t - t_1_sync[i]) * std::pow(t, 3.0);
+                    const double factor = -1.0 / std::pow(t_1_sync[i], 3.0) * dq_max_sync_[i] * sign_delta_q[i];
+                    q_delta_d[i] = factor * (0.5 * t - t_1_sync[i]) * std::pow(t, 3.0);
+                    dq_d[i] = factor * (2.0 * t - 3.0 * t_1_sync[i]) * std::pow(t, 2.0);
+                    ddq_d[i] = factor * 6.0 * (t - t_1_sync[i]) * t;
+                    motion_finished = false;
                 } else if (t >= t_1_sync[i] && t < t_2_sync[i]) {
                     q_delta_d[i] = q_1_[i] + (t - t_1_sync[i]) * dq_max_sync_[i] * sign_delta_q[i];
+                    dq_d[i] = dq_max_sync_[i] * sign_delta_q[i];
+                    ddq_d[i] = 0;
+                    motion_finished = false;
                 } else if (t >= t_2_sync[i] && t < t_f_sync[i]) {
+                    const double u = t - t_1_sync[i] - t_d[i]; // Time since t_2_sync
+                    const double factor = 0.5 / std::pow(delta_t_2_sync[i], 3.0) * dq_max_sync_[i] * sign_delta_q[i];
                     q_delta_d[i] = q_delta[i] + 0.5 * (1.0 / std::pow(delta_t_2_sync[i], 3.0) * (t - t_1_sync[i] - 2.0 * delta_t_2_sync[i] - t_d[i]) * std::pow((t - t_1_sync[i] - t_d[i]), 3.0) + (2.0 * t - 2.0 * t_1_sync[i] - delta_t_2_sync[i] - 2.0 * t_d[i])) * dq_max_sync_[i] * sign_delta_q[i];
+                    dq_d[i] = factor * (4.0 * u - 6.0 * delta_t_2_sync[i]) * std::pow(u, 2.0) + dq_max_sync_[i] * sign_delta_q[i];
+                    ddq_d[i] = factor * 12.0 * (u - delta_t_2_sync[i]) * u;
+                    motion_finished = false;
                 } else {
                     q_delta_d[i] = q_delta[i];
-                    joint_motion_finished[i] = true;
+                    dq_d[i] = 0;
+                    ddq_d[i] = 0;
                 }
             }
         }
-        return std::all_of(joint_motion_finished.cbegin(), joint_motion_finished.cend(), [](bool x) { return x; });
+        return motion_finished;
     }
 
 public:
+    const size_t degrees_of_freedom;
     double delta_time;
 
-    explicit Smoothie(double delta_time): delta_time(delta_time) { }
+    template<size_t D = DOFs, std::enable_if_t<(D >= 1), int> = 0>
+    explicit Smoothie(double delta_time): degrees_of_freedom(DOFs), delta_time(delta_time) { }
+
+    template<size_t D = DOFs, std::enable_if_t<(D == 0), int> = 0>
+    explicit Smoothie(size_t degrees_of_freedom, double delta_time): current_input(degrees_of_freedom), dq_max_sync_(degrees_of_freedom), q_1_(degrees_of_freedom), t_1_sync(degrees_of_freedom), t_2_sync(degrees_of_freedom), t_f_sync(degrees_of_freedom), degrees_of_freedom(degrees_of_freedom), delta_time(delta_time) { }
 
     Result update(const InputParameter<DOFs>& input, OutputParameter<DOFs>& output) {
         time += delta_time;
 
-        if (input != current_input) {
+        if (input.has_changed(current_input)) {
             current_input = input;
 
             if ((input.max_velocity.array() <= 0.0).any() || (input.max_acceleration.array() <= 0.0).any()) {
@@ -118,25 +138,35 @@ public:
             calculateSynchronizedValues();
         }
 
-        Vector q_delta_d;
-        bool motion_finished = calculateDesiredValues(time, q_delta_d);
+        Vector q_delta_d(q_delta.size());
+        bool motion_finished = calculateDesiredValues(time, q_delta_d, output.new_velocity, output.new_acceleration);
 
         output.new_position = q_initial + q_delta_d;
-        output.new_velocity = Vector::Zero();
-        output.new_acceleration = Vector::Zero();
-
-        current_input.current_position = output.new_position;
-        current_input.current_velocity = output.new_velocity;
-        current_input.current_acceleration = output.new_acceleration;
 
         if (motion_finished) {
             output.new_position = input.target_position;
             output.new_velocity = input.target_velocity;
             output.new_acceleration = input.target_acceleration;
+        }
 
-            return Result::Finished;
+        current_input.current_position = output.new_position;
+        current_input.current_velocity = output.new_velocity;
+        current_input.current_acceleration = output.new_acceleration;
+        return motion_finished ? Result::Finished : Result::Working;
+    }
+
+    //! Sample the last calculated trajectory at the times t0 + i dt into buffers with a row per sample and a column per DoF
+    void sample(double t0, double dt, Eigen::Ref<Eigen::MatrixXd> positions, Eigen::Ref<Eigen::MatrixXd> velocities, Eigen::Ref<Eigen::MatrixXd> accelerations) const {
+        Vector q_delta_d(q_delta.size()), dq_d(q_delta.size()), ddq_d(q_delta.size());
+        for (Eigen::Index i = 0; i < positions.rows(); i += 1) {
+            if (calculateDesiredValues(t0 + i * dt, q_delta_d, dq_d, ddq_d)) {
+                positions.row(i) = current_input.target_position.transpose();
+            } else {
+                positions.row(i) = (q_initial + q_delta_d).transpose();
+            }
+            velocities.row(i) = dq_d.transpose();
+            accelerations.row(i) = ddq_d.transpose();
         }
-        return Result::Working;
     }
 };
 
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace movex {
+
+/**
+ * Persistent threads that run the iterations of a loop in parallel, e.g. Step 1 and Step 2 of many DoFs.
+ * The threads are created once, and the calling thread takes part in each loop. The calling thread never locks a mutex and only waits
+ * for iterations that a worker has already claimed, so a worker that is not scheduled in time doesn't delay the loop. Still, the workers
+ * should run with at least the priority of the calling thread (see the constructor), e.g. for a real-time control cycle.
+ */
+class WorkerPool {
+    static constexpr uint64_t index_mask {0xffffffff};
+
+    std::vector<std::thread> workers;
+
+    std::mutex mutex; // Only for sleeping workers
+    std::condition_variable start_condition;
+    std::atomic<uint32_t> generation {0};
+    bool stop {false};
+
+    std::atomic<bool> is_busy {false}; // Whether a thread is running a loop in the pool
+
+    // Current loop, type-erased without allocation. Only read after claiming an iteration, so it stays valid until the iteration is done.
+    const void* context {nullptr};
+    bool (*call)(const void*, size_t) {nullptr};
+    std::atomic<size_t> number {0};
+
+    // Generation of the loop (upper half) and next unclaimed iteration (lower half), so that a late worker can't claim an iteration of another loop
+    std::atomic<uint64_t> state {0};
+    std::atomic<size_t> number_done {0};
+    std::atomic<bool> is_cancelled {false};
+
+    //! Claim the iterations in increasing order, so that all iterations before a cancelling one are run as well
+    void run(uint32_t loop_generation) {
+        uint64_t current = state.load();
+        while (!is_cancelled.load(std::memory_order_relaxed)) {
+            if ((current >> 32) != loop_generation || (current & index_mask) >= number.load(std::memory_order_relaxed)) {
+                return;
+            }
+
+            if (!state.compare_exchange_weak(current, current + 1)) {
+                continue;
+            }
+
+            if (!call(context, current & index_mask)) {
+                is_cancelled.store(true, std::memory_order_relaxed);
+            }
+            number_done.fetch_add(1, std::memory_order_release);
+            current = state.load();
+        }
+    }
+
+    void work(size_t index, const std::function<void(size_t)>& init) {
+        if (init) {
+            init(index);
+        }
+
+        uint32_t last_generation {0};
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                start_condition.wait(lock, [&] { return stop || generation.load() != last_generation; });
+                if (stop) {
+                    return;
+                }
+                last_generation = generation.load();
+            }
+
+            run(last_generation);
+        }
+    }
+
+public:
+    /**
+     * Number of additional threads, so that number_threads + 1 iterations run in parallel. The optional init(index) is called at the start of
+     * each thread, e.g. to set its real-time priority and CPU affinity via pthread_setschedparam and pthread_setaffinity_np.
+     */
+    explicit WorkerPool(size_t number_threads, std::function<void(size_t)> init = {}) {
+        workers.reserve(number_threads);
+        for (size_t i = 0; i < number_threads; i += 1) {
+            workers.emplace_back(&WorkerPool::work, this, i, init);
+        }
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        start_condition.notify_all();
+        for (auto& worker: workers) {
+            worker.join();
+        }
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    size_t get_number_threads() const {
+        return workers.size();
+    }
+
+    /**
+     * Calls func(i) for all i in [0, n) and returns once all calls are done. If a call returns false, the remaining iterations are skipped,
+     * while the iterations before are always run. If another loop is running in the pool, e.g. of another thread sharing the pool or
+     * from within func, the iterations are run serially in the calling thread instead of waiting for the pool.
+     */
+    template<class Func>
+    void for_each(size_t n, const Func& func) {
+        if (workers.empty() || n < 2 || is_busy.exchange(true, std::memory_order_acquire)) {
+            for (size_t i = 0; i < n; i += 1) {
+                if (!func(i)) {
+                    return;
+                }
+            }
+            return;
+        }
+
+        context = &func;
+        call = [](const void* f, size_t i) { return (*static_cast<const Func*>(f))(i); };
+        number.store(n, std::memory_order_relaxed);
+        number_done.store(0, std::memory_order_relaxed);
+        is_cancelled.store(false, std::memory_order_relaxed);
+
+        const uint32_t loop_generation = generation.load(std::memory_order_relaxed) + 1;
+        state.store(static_cast<uint64_t>(loop_generation) << 32);
+
+        // Without the mutex, a worker that is just going to sleep might miss this loop, which only reduces the parallelism
+        generation.store(loop_generation);
+        start_condition.notify_all();
+
+        run(loop_generation);
+
+        // Close the loop, and wait only for the iterations that were claimed before
+        const size_t number_claimed = state.exchange((static_cast<uint64_t>(loop_generation) << 32) | index_mask) & index_mask;
+        while (number_done.load(std::memory_order_acquire) < number_claimed) {
+            std::this_thread::yield();
+        }
+        is_busy.store(false, std::memory_order_release);
+    }
+};
+
+} // namespace movex
@@ -1,9 +1,12 @@
 #include <array>
+#include <optional>
 #include <string>
+#include <type_traits>
 
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 #include <pybind11/eigen.h>
+#include <pybind11/numpy.h>
 #include <pybind11/operators.h>
 
 #include <movex/otg/quintic.hpp>
@@ -23,10 +26,65 @@ using namespace pybind11::literals; // to bring in the `_a` literal
 using namespace movex;
 
 
+//! Sample the last trajectory of the OTG into new NumPy arrays (samples x DoFs), which are column-major so that they are filled in place
+template<class OTG>
+py::tuple sample(const OTG& otg, double t0, double dt, size_t n) {
+    const py::ssize_t rows = n, cols = otg.degrees_of_freedom;
+    py::array_t<double, py::array::f_style> positions({rows, cols}), velocities({rows, cols}), accelerations({rows, cols});
+    otg.sample(t0, dt, Eigen::Map<Eigen::MatrixXd>(positions.mutable_data(), rows, cols), Eigen::Map<Eigen::MatrixXd>(velocities.mutable_data(), rows, cols), Eigen::Map<Eigen::MatrixXd>(accelerations.mutable_data(), rows, cols));
+    return py::make_tuple(positions, velocities, accelerations);
+}
+
+//! Sample the last trajectory of the OTG into caller-provided NumPy arrays, e.g. to reuse them in a loop. They need to be column-major
+//! double arrays (e.g. np.empty((n, dofs), order='F')) with the same number of rows and a column per DoF, as they are filled in place.
+template<class OTG>
+void sample_into(const OTG& otg, double t0, double dt, py::array_t<double, py::array::f_style> positions, py::array_t<double, py::array::f_style> velocities, py::array_t<double, py::array::f_style> accelerations) {
+    const py::ssize_t cols = otg.degrees_of_freedom;
+    const py::ssize_t rows = (positions.ndim() == 2) ? positions.shape(0) : -1;
+    for (const auto* array: {&positions, &velocities, &accelerations}) {
+        if (array->ndim() != 2 || array->shape(0) != rows || array->shape(1) != cols) {
+            throw py::value_error("sample buffers need the same shape (samples, " + std::to_string(cols) + ")");
+        }
+        if (!array->writeable()) {
+            throw py::value_error("sample buffers need to be writeable");
+        }
+    }
+
+    otg.sample(t0, dt, Eigen::Map<Eigen::MatrixXd>(positions.mutable_data(), rows, cols), Eigen::Map<Eigen::MatrixXd>(velocities.mutable_data(), rows, cols), Eigen::Map<Eigen::MatrixXd>(accelerations.mutable_data(), rows, cols));
+}
+
+
+//! Getter of a field, e.g. read-only for NumPy arrays so that they can't be modified in place
+template<class Class, class T>
+auto getter(T Class::*field) {
+    return [field](const Class& self) -> const T& { return self.*field; };
+}
+
+//! Setter of an input field. It marks a tracked input as changed only for a new value, so that setting all fields in each
+//! control cycle doesn't force a calculation. An untracked input stays untracked and is compared by value.
+template<class Class, class T>
+auto marked_setter(T Class::*field) {
+    return [field](Class& self, const T& value) {
+        bool is_equal;
+        if constexpr (std::is_base_of_v<Eigen::MatrixBase<T>, T>) {
+            is_equal = (value.size() == (self.*field).size() && value == self.*field);
+        } else {
+            is_equal = (value == self.*field);
+        }
+
+        self.*field = value;
+        if (self.get_version() != 0 && !is_equal) {
+            self.mark_changed();
+        }
+    };
+}
+
+
 PYBIND11_MODULE(_movex, m) {
     m.doc() = "Robot Motion Library with Focus on Online Trajectory Generation";
 
-    constexpr size_t DOFs {2};
+    constexpr size_t DOFs {0}; // Set at runtime
+    constexpr size_t default_degrees_of_freedom {7}; // Of the Franka robot
 
     py::class_<Affine>(m, "Affine")
         .def(py::init<double, double, double, double, double, double>(), "x"_a=0.0, "y"_a=0.0, "z"_a=0.0, "a"_a=0.0, "b"_a=0.0, "c"_a=0.0)
@@ -53,26 +111,51 @@ PYBIND11_MODULE(_movex, m) {
         .def("slerp", &Affine::slerp, "affine"_a, "t"_a)
         .def("__repr__", &Affine::toString);
 
-    py::class_<InputParameter<DOFs>>(m, "InputParameter")
-        .def(py::init<>())
-        .def_readonly_static("degrees_of_freedom", &InputParameter<DOFs>::degrees_of_freedom)
+    py::class_<InputParameter<DOFs>> input_parameter(m, "InputParameter");
+    py::enum_<InputParameter<DOFs>::Type>(input_parameter, "Type")
+        .value("Position", InputParameter<DOFs>::Type::Position)
+        .value("Velocity", InputParameter<DOFs>::Type::Velocity)
+        .export_values();
+
+    py::enum_<InputParameter<DOFs>::Synchronization>(input_parameter, "Synchronization")
+        .value("Time", InputParameter<DOFs>::Synchronization::Time)
+        .value("Phase", InputParameter<DOFs>::Synchronization::Phase)
+        .value("No", InputParameter<DOFs>::Synchronization::None) // None is reserved in Python
+        .export_values();
+
+    py::enum_<InputParameter<DOFs>::DurationDiscretization>(input_parameter, "DurationDiscretization")
+        .value("Continuous", InputParameter<DOFs>::DurationDiscretization::Continuous)
+        .value("Discrete", InputParameter<DOFs>::DurationDiscretization::Discrete)
+        .export_values();
+
+    input_parameter
+        .def(py::init<size_t>(), "degrees_of_freedom"_a = default_degrees_of_freedom)
+        .def_property_readonly("degrees_of_freedom", &InputParameter<DOFs>::get_degrees_of_freedom)
         .def_readwrite("current_position", &InputParameter<DOFs>::current_position)
         .def_readwrite("current_velocity", &InputParameter<DOFs>::current_velocity)
         .def_readwrite("current_acceleration", &InputParameter<DOFs>::current_acceleration)
-        .def_readwrite("target_position", &InputParameter<DOFs>::target_position)
-        .def_readwrite("target_velocity", &InputParameter<DOFs>::target_velocity)
-        .def_readwrite("target_acceleration", &InputParameter<DOFs>::target_acceleration)
-        .def_readwrite("max_velocity", &InputParameter<DOFs>::max_velocity)
-        .def_readwrite("max_acceleration", &InputParameter<DOFs>::max_acceleration)
-        .def_readwrite("max_jerk", &InputParameter<DOFs>::max_jerk)
-        .def_readwrite("minimum_duration", &InputParameter<DOFs>::minimum_duration);
+        .def_property("target_position", getter(&InputParameter<DOFs>::target_position), marked_setter(&InputParameter<DOFs>::target_position))
+        .def_property("target_velocity", getter(&InputParameter<DOFs>::target_velocity), marked_setter(&InputParameter<DOFs>::target_velocity))
+        .def_property("target_acceleration", getter(&InputParameter<DOFs>::target_acceleration), marked_setter(&InputParameter<DOFs>::target_acceleration))
+        .def_property("max_velocity", getter(&InputParameter<DOFs>::max_velocity), marked_setter(&InputParameter<DOFs>::max_velocity))
+        .def_property("max_acceleration", getter(&InputParameter<DOFs>::max_acceleration), marked_setter(&InputParameter<DOFs>::max_acceleration))
+        .def_property("max_jerk", getter(&InputParameter<DOFs>::max_jerk), marked_setter(&InputParameter<DOFs>::max_jerk))
+        .def_property("enabled", getter(&InputParameter<DOFs>::enabled), marked_setter(&InputParameter<DOFs>::enabled))
+        .def_property("minimum_duration", getter(&InputParameter<DOFs>::minimum_duration), marked_setter(&InputParameter<DOFs>::minimum_duration))
+        .def_property("type", getter(&InputParameter<DOFs>::type), marked_setter(&InputParameter<DOFs>::type))
+        .def_property("synchronization", getter(&InputParameter<DOFs>::synchronization), marked_setter(&InputParameter<DOFs>::synchronization))
+        .def_property("duration_discretization", getter(&InputParameter<DOFs>::duration_discretization), marked_setter(&InputParameter<DOFs>::duration_discretization))
+        .def_property_readonly("version", &InputParameter<DOFs>::get_version)
+        .def("set_stop", &InputParameter<DOFs>::set_stop, "synchronization"_a = InputParameter<DOFs>::Synchronization::None)
+        .def("mark_changed", &InputParameter<DOFs>::mark_changed);
 
     py::class_<OutputParameter<DOFs>>(m, "OutputParameter")
-        .def(py::init<>())
+        .def(py::init<size_t>(), "degrees_of_freedom"_a = default_degrees_of_freedom)
         .def_readwrite("new_position", &OutputParameter<DOFs>::new_position)
         .def_readwrite("new_velocity", &OutputParameter<DOFs>::new_velocity)
         .def_readwrite("new_acceleration", &OutputParameter<DOFs>::new_acceleration)
         .def_readwrite("duration", &OutputParameter<DOFs>::duration)
+        .def("pass_to_input", &OutputParameter<DOFs>::pass_to_input, "input"_a)
         .def("__copy__",  [](const OutputParameter<DOFs> &self) {
             return OutputParameter<DOFs>(self);
         });
@@ -81,28 +164,108 @@ PYBIND11_MODULE(_movex, m) {
         .value("Working", Result::Working)
         .value("Finished", Result::Finished)
         .value("Error", Result::Error)
+        .value("ErrorInvalidInput", Result::ErrorInvalidInput)
+        .value("ErrorExecutionTimeCalculation", Result::ErrorExecutionTimeCalculation)
+        .value("ErrorSynchronizationCalculation", Result::ErrorSynchronizationCalculation)
+        .value("ErrorCalculationTimeout", Result::ErrorCalculationTimeout)
         .export_values();
 
+    py::class_<CalculationError>(m, "CalculationError")
+        .def_readonly("result", &CalculationError::result)
+        .def_readonly("dof", &CalculationError::dof)
+        .def("__repr__", &CalculationError::to_string);
+
+    py::enum_<Profile::Type>(m, "ProfileType")
+        .value("UP_ACC0_ACC1_VEL", Profile::Type::UP_ACC0_ACC1_VEL)
+        .value("UP_VEL", Profile::Type::UP_VEL)
+        .value("UP_ACC0", Profile::Type::UP_ACC0)
+        .value("UP_ACC1", Profile::Type::UP_ACC1)
+        .value("UP_ACC0_ACC1", Profile::Type::UP_ACC0_ACC1)
+        .value("UP_ACC0_VEL", Profile::Type::UP_ACC0_VEL)
+        .value("UP_ACC1_VEL", Profile::Type::UP_ACC1_VEL)
+        .value("UP_NONE", Profile::Type::UP_NONE)
+        .value("DOWN_ACC0_ACC1_VEL", Profile::Type::DOWN_ACC0_ACC1_VEL)
+        .value("DOWN_VEL", Profile::Type::DOWN_VEL)
+        .value("DOWN_ACC0", Profile::Type::DOWN_ACC0)
+        .value("DOWN_ACC1", Profile::Type::DOWN_ACC1)
+        .value("DOWN_ACC0_ACC1", Profile::Type::DOWN_ACC0_ACC1)
+        .value("DOWN_ACC0_VEL", Profile::Type::DOWN_ACC0_VEL)
+        .value("DOWN_ACC1_VEL", Profile::Type::DOWN_ACC1_VEL)
+        .value("DOWN_NONE", Profile::Type::DOWN_NONE);
+
+    py::class_<PositionExtrema>(m, "PositionExtrema")
+        .def_readonly("min", &PositionExtrema::min)
+        .def_readonly("max", &PositionExtrema::max)
+        .def_readonly("t_min", &PositionExtrema::t_min)
+        .def_readonly("t_max", &PositionExtrema::t_max);
+
+    py::class_<RuckigStatistics, std::shared_ptr<RuckigStatistics>>(m, "RuckigStatistics")
+        .def(py::init<>())
+        .def_property_readonly("calculations", [](const RuckigStatistics& self) { return self.calculations.load(); })
+        .def_property_readonly("brakes", [](const RuckigStatistics& self) { return self.brakes.load(); })
+        .def_property_readonly("step1_fallbacks", [](const RuckigStatistics& self) { return self.step1_fallbacks.load(); })
+        .def_property_readonly("step2_fallbacks", [](const RuckigStatistics& self) { return self.step2_fallbacks.load(); })
+        .def_property_readonly("failures", [](const RuckigStatistics& self) { return self.failures.load(); })
+        .def_property_readonly("calculation_histogram", &RuckigStatistics::get_calculation_histogram)
+        .def("step1_histogram", &RuckigStatistics::get_step1_histogram, "type"_a)
+        .def_static("bin_upper_bound", &RuckigStatistics::bin_upper_bound, "bin"_a)
+        .def("reset", &RuckigStatistics::reset);
+
+    py::class_<WorkerPool, std::shared_ptr<WorkerPool>>(m, "WorkerPool")
+        .def(py::init([](size_t number_threads) { return std::make_shared<WorkerPool>(number_threads); }), "number_threads"_a)
+        .def_property_readonly("number_threads", &WorkerPool::get_number_threads);
+
     py::class_<Quintic<DOFs>>(m, "Quintic")
-        .def(py::init<double>(), "delta_time"_a)
+        .def(py::init<size_t, double>(), "degrees_of_freedom"_a, "delta_time"_a)
+        .def(py::init([](double delta_time) { return new Quintic<DOFs>(default_degrees_of_freedom, delta_time); }), "delta_time"_a)
+        .def_readonly("degrees_of_freedom", &Quintic<DOFs>::degrees_of_freedom)
         .def_readonly("delta_time", &Quintic<DOFs>::delta_time)
-        .def("update", &Quintic<DOFs>::update);
+        .def("update", &Quintic<DOFs>::update)
+        .def("sample", &sample<Quintic<DOFs>>, "t0"_a, "dt"_a, "n"_a)
+        .def("sample", &sample_into<Quintic<DOFs>>, "t0"_a, "dt"_a, "positions"_a.noconvert(), "velocities"_a.noconvert(), "accelerations"_a.noconvert());
 
     py::class_<Smoothie<DOFs>>(m, "Smoothie")
-        .def(py::init<double>(), "delta_time"_a)
+        .def(py::init<size_t, double>(), "degrees_of_freedom"_a, "delta_time"_a)
+        .def(py::init([](double delta_time) { return new Smoothie<DOFs>(default_degrees_of_freedom, delta_time); }), "delta_time"_a)
+        .def_readonly("degrees_of_freedom", &Smoothie<DOFs>::degrees_of_freedom)
         .def_readonly("delta_time", &Smoothie<DOFs>::delta_time)
-        .def("update", &Smoothie<DOFs>::update);
+        .def("update", &Smoothie<DOFs>::update)
+        .def("sample", &sample<Smoothie<DOFs>>, "t0"_a, "dt"_a, "n"_a)
+        .def("sample", &sample_into<Smoothie<DOFs>>, "t0"_a, "dt"_a, "positions"_a.noconvert(), "velocities"_a.noconvert(), "accelerations"_a.noconvert());
 
     py::class_<Ruckig<DOFs>>(m, "Ruckig")
-        .def(py::init<double>(), "delta_time"_a)
+        .def(py::init<size_t, double>(), "degrees_of_freedom"_a, "delta_time"_a)
+        .def(py::init([](double delta_time) { return new Ruckig<DOFs>(default_degrees_of_freedom, delta_time); }), "delta_time"_a)
+        .def_readonly("degrees_of_freedom", &Ruckig<DOFs>::degrees_of_freedom)
         .def_readonly("delta_time", &Ruckig<DOFs>::delta_time)
         .def_readonly("last_calculation_duration", &Ruckig<DOFs>::last_calculation_duration)
+        .def_readwrite("calculation_budget", &Ruckig<DOFs>::calculation_budget)
+        .def_property_readonly("error", &Ruckig<DOFs>::get_error)
+        .def_readwrite("statistics", &Ruckig<DOFs>::statistics)
+        .def_readwrite("worker_pool", &Ruckig<DOFs>::worker_pool)
         .def("update", &Ruckig<DOFs>::update)
-        .def("at_time", &Ruckig<DOFs>::atTime);
+        .def("at_time", &Ruckig<DOFs>::atTime)
+        .def("sample", &sample<Ruckig<DOFs>>, "t0"_a, "dt"_a, "n"_a)
+        .def("sample", &sample_into<Ruckig<DOFs>>, "t0"_a, "dt"_a, "positions"_a.noconvert(), "velocities"_a.noconvert(), "accelerations"_a.noconvert())
+        .def("get_position_extrema", [](const Ruckig<DOFs>& self) {
+            return self.get_trajectory().get_position_extrema();
+        })
+        .def("get_first_time_at_position", [](const Ruckig<DOFs>& self, size_t dof, double position) -> std::optional<double> {
+            if (dof >= self.degrees_of_freedom) {
+                throw py::index_error("dof " + std::to_string(dof) + " is out of range for " + std::to_string(self.degrees_of_freedom) + " DoFs");
+            }
+
+            double time;
+            if (!self.get_trajectory().get_first_time_at_position(dof, position, time)) {
+                return std::nullopt;
+            }
+            return time;
+        }, "dof"_a, "position"_a);
 
 #ifdef WITH_REFLEXXES
     py::class_<Reflexxes<DOFs>>(m, "Reflexxes")
-        .def(py::init<double>(), "delta_time"_a)
+        .def(py::init<size_t, double>(), "degrees_of_freedom"_a, "delta_time"_a)
+        .def(py::init([](double delta_time) { return new Reflexxes<DOFs>(default_degrees_of_freedom, delta_time); }), "delta_time"_a)
         .def_readonly("delta_time", &Reflexxes<DOFs>::delta_time)
         .def("update", &Reflexxes<DOFs>::update)
         .def("at_time", &Reflexxes<DOFs>::atTime);
@@ -34,6 +34,16 @@ bool Profile::check(double pf, double vf, double vMax, double aMax) const {
         && std::abs(p[7] - pf) < 2e-7 && std::abs(v[7] - vf) < 1e-7;
 }
 
+bool Profile::check(double tf, double pf, double vf, double vMax, double aMax) const {
+    return check(pf, vf, vMax, aMax) && std::abs(t_sum[6] - tf) < 1e-8;
+}
+
+bool Profile::check_for_velocity(double vf, double af, double aMax) const {
+    return std::all_of(t.begin(), t.end(), [](double tm){ return tm >= 0; })
+        && std::all_of(a.begin() + 1, a.end(), [aMax](double am){ return std::abs(am) < std::abs(aMax) + 1e-9; })
+        && std::abs(v[7] - vf) < 1e-8 && std::abs(a[7] - af) < 1e-8;
+}
+
 std::tuple<double, double, double> Profile::integrate(double t, double p0, double v0, double a0, double j) {
     const double p_new = p0 + t * v0 + std::pow(t, 2) * a0 / 2 + std::pow(t, 3) * j / 6;
     const double v_new = v0 + t * a0 + std::pow(t, 2) * j / 2;
@@ -41,7 +51,190 @@ std::tuple<double, double, double> Profile::integrate(double t, double p0, doubl
     return {p_new, v_new, a_new};
 }
 
-bool RuckigStep1::time_up_acc0_acc1_vel(Profile& profile, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
+std::tuple<double, double, double> Profile::set_brake(double p0, double v0, double a0, double vMax, double aMax, double jMax) {
+    RuckigStep1::get_brake_trajectory(v0, a0, vMax, aMax, jMax, t_brakes, j_brakes);
+    t_brake = t_brakes[0] + t_brakes[1];
+
+    if (t_brakes[0] > 0.0) {
+        p_brakes[0] = p0;
+        v_brakes[0] = v0;
+        a_brakes[0] = a0;
+        std::tie(p0, v0, a0) = integrate(t_brakes[0], p0, v0, a0, j_brakes[0]);
+
+        if (t_brakes[1] > 0.0) {
+            p_brakes[1] = p0;
+            v_brakes[1] = v0;
+            a_brakes[1] = a0;
+            std::tie(p0, v0, a0) = integrate(t_brakes[1], p0, v0, a0, j_brakes[1]);
+        }
+    }
+    return {p0, v0, a0};
+}
+
+Profile Profile::scale(double factor, double p0, double p0_reference) const {
+    Profile result = *this;
+    for (size_t i = 0; i < 7; i += 1) {
+        result.j[i] = factor * j[i];
+    }
+    for (size_t i = 0; i < 8; i += 1) {
+        result.a[i] = factor * a[i];
+        result.v[i] = factor * v[i];
+        result.p[i] = p0 + factor * (p[i] - p0_reference);
+    }
+    for (size_t i = 0; i < 2; i += 1) {
+        result.j_brakes[i] = factor * j_brakes[i];
+        result.a_brakes[i] = factor * a_brakes[i];
+        result.v_brakes[i] = factor * v_brakes[i];
+        result.p_brakes[i] = p0 + factor * (p_brakes[i] - p0_reference);
+    }
+    return result;
+}
+
+void Profile::state_at_time(double time, double& p_new, double& v_new, double& a_new) const {
+    double t_diff = time;
+    if (t_brake.has_value()) {
+        if (t_diff < t_brake.value()) {
+            size_t index = (t_diff < t_brakes[0]) ? 0 : 1;
+            if (index > 0) {
+                t_diff -= t_brakes[index - 1];
+            }
+
+            std::tie(p_new, v_new, a_new) = integrate(t_diff, p_brakes[index], v_brakes[index], a_brakes[index], j_brakes[index]);
+            return;
+        } else {
+            t_diff -= t_brake.value();
+        }
+    }
+
+    if (t_diff >= t_sum[6]) {
+        state_at_segment(segments - 1, time, p_new, v_new, a_new);
+        return;
+    }
+
+    auto index_ptr = std::upper_bound(t_sum.begin(), t_sum.end(), t_diff);
+    size_t index = std::distance(t_sum.begin(), index_ptr);
+
+    if (index > 0) {
+        t_diff -= t_sum[index - 1];
+    }
+
+    std::tie(p_new, v_new, a_new) = integrate(t_diff, p[index], v[index], a[index], j[index]);
+}
+
+PositionExtrema Profile::get_position_extrema() const {
+    const double p_start = (t_brake.value_or(0.0) > 0.0) ? p_brakes[0] : p[0];
+    PositionExtrema extrema {p_start, p_start, 0.0, 0.0};
+
+    auto check_position = [&extrema](double time, double position) {
+        if (position < extrema.min) {
+            extrema.min = position;
+            extrema.t_min = time;
+        }
+        if (position > extrema.max) {
+            extrema.max = position;
+            extrema.t_max = time;
+        }
+    };
+
+    for_each_segment([&](double t_start, double t, double p0, double v0, double a0, double jerk) {
+        // Roots of the velocity v0 + a0 τ + jerk τ^2 / 2 within the segment
+        if (jerk != 0.0) {
+            const double discriminant = a0 * a0 - 2 * jerk * v0;
+            if (discriminant >= 0.0) {
+                const double h = std::sqrt(discriminant);
+                for (const double tau: {(-a0 - h) / jerk, (-a0 + h) / jerk}) {
+                    if (tau > 0.0 && tau < t) {
+                        check_position(t_start + tau, std::get<0>(integrate(tau, p0, v0, a0, jerk)));
+                    }
+                }
+            }
+        } else if (a0 != 0.0) {
+            const double tau = -v0 / a0;
+            if (tau > 0.0 && tau < t) {
+                check_position(t_start + tau, std::get<0>(integrate(tau, p0, v0, a0, jerk)));
+            }
+        }
+
+        check_position(t_start + t, std::get<0>(integrate(t, p0, v0, a0, jerk)));
+    });
+
+    return extrema;
+}
+
+bool Profile::get_first_time_at_position(double position, double& time) const {
+    // Tolerance for roots at the segment boundaries, and the position precision of the profiles (see check), e.g. for the target position
+    constexpr double eps {1e-12};
+    constexpr double p_precision {2e-7};
+
+    bool found {false};
+    for_each_segment([&](double t_start, double t, double p0, double v0, double a0, double jerk) {
+        if (found) {
+            return;
+        }
+
+        const std::array<double, 4> polynom {jerk / 6, a0 / 2, v0, p0 - position};
+        for (double tau: Roots::solveCub(polynom[0], polynom[1], polynom[2], polynom[3])) {
+            tau = Roots::polishRoot(polynom, tau);
+            if (tau < -eps || tau > t + eps) {
+                continue;
+            }
+
+            time = t_start + std::clamp(tau, 0.0, t);
+            found = true;
+            return;
+        }
+
+        if (std::abs(std::get<0>(integrate(t, p0, v0, a0, jerk)) - position) < p_precision) {
+            time = t_start + t;
+            found = true;
+        }
+    });
+    return found;
+}
+
+void Profile::sample(double t0, double dt, size_t n, double* positions, double* velocities, double* accelerations) const {
+    // Horner evaluation over a contiguous range of samples without branches, so that the compiler can vectorize the loop
+    auto fill = [&](size_t begin, size_t end, double t_start, double p0, double v0, double a0, double jerk) {
+        const double a0_2 = a0 / 2, j_2 = jerk / 2, j_6 = jerk / 6;
+        const double t_offset = t0 - t_start;
+        for (size_t i = begin; i < end; i += 1) {
+            const double tau = t_offset + i * dt;
+            positions[i] = p0 + tau * (v0 + tau * (a0_2 + tau * j_6));
+            velocities[i] = v0 + tau * (a0 + tau * j_2);
+            accelerations[i] = a0 + tau * jerk;
+        }
+    };
+
+    // Samples before the start are extrapolated with the first segment, as in state_at_time
+    size_t index {0};
+    for_each_segment([&](double t_start, double t, double p0, double v0, double a0, double jerk) {
+        size_t end {index};
+        while (end < n && t0 + end * dt < t_start + t) {
+            end += 1;
+        }
+        fill(index, end, t_start, p0, v0, a0, jerk);
+        index = end;
+    });
+
+    // Continue with the final velocity and acceleration
+    fill(index, n, duration(), p[7], v[7], a[7], 0.0);
+}
+
+void ProfileCache::remember(Profile::Type type) {
+    // Move to front, drop the least recent type if full
+    size_t index = std::distance(recent.begin(), std::find(recent.begin(), recent.begin() + length, type));
+    if (index == length) {
+        length = std::min(length + 1, capacity);
+        index = length - 1;
+    }
+
+    for (size_t i = index; i > 0; i -= 1) {
+        recent[i] = recent[i - 1];
+    }
+    recent[0] = type;
+}
+
+void RuckigStep1::time_up_acc0_acc1_vel(Profile& profile, ValidProfiles& valid, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
     profile.t[0] = (-a0 + aMax)/jMax;
     profile.t[1] = (Power(a0,2) - 2*Power(aMax,2) - 2*jMax*v0 + 2*jMax*vMax)/(2*aMax*jMax);
     profile.t[2] = aMax/jMax;
@@ -51,7 +244,7 @@ bool RuckigStep1::time_up_acc0_acc1_vel(Profile& profile, double p0, double v0,
     profile.t[6] = profile.t[2];
 
     profile.set(p0, v0, a0, {jMax, 0, -jMax, 0, -jMax, 0, jMax});
-    return profile.check(pf, vf, vMax, aMax);
+    valid.add_if_valid(profile, pf, vf, vMax, aMax);
 }
 
 bool RuckigStep2::time_up_acc0_acc1_vel(Profile& profile, double tf, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
@@ -66,7 +259,7 @@ bool RuckigStep2::time_up_acc0_acc1_vel(Profile& profile, double tf, double p0,
         profile.t[6] = profile.t[2];
 
         profile.set(p0, v0, a0, {jMax, 0, -jMax, 0, -jMax, 0, jMax});
-        if (profile.check(pf, vf, vMax, aMax)) {
+        if (profile.check(tf, pf, vf, vMax, aMax)) {
             return true;
         }
     }
@@ -82,7 +275,7 @@ bool RuckigStep2::time_up_acc0_acc1_vel(Profile& profile, double tf, double p0,
         profile.t[6] = profile.t[2];
 
         profile.set(p0, v0, a0, {jMax, 0, -jMax, 0, jMax, 0, -jMax});
-        if (profile.check(pf, vf, vMax, aMax)) {
+        if (profile.check(tf, pf, vf, vMax, aMax)) {
             return true;
         }
     }
@@ -90,7 +283,7 @@ bool RuckigStep2::time_up_acc0_acc1_vel(Profile& profile, double tf, double p0,
     return false;
 }
 
-bool RuckigStep1::time_up_acc1_vel(Profile& profile, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
+void RuckigStep1::time_up_acc1_vel(Profile& profile, ValidProfiles& valid, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
     profile.t[0] = (-2*a0*jMax + Sqrt(2)*Sqrt(Power(a0,2) + 2*jMax*(-v0 + vMax))*Abs(jMax))/(2*Power(jMax,2));
     profile.t[1] = 0;
     profile.t[2] = Sqrt(Power(a0,2)/2 + jMax*(-v0 + vMax))/Abs(jMax);
@@ -100,7 +293,7 @@ bool RuckigStep1::time_up_acc1_vel(Profile& profile, double p0, double v0, doubl
     profile.t[6] = profile.t[4];
 
     profile.set(p0, v0, a0, {jMax, 0, -jMax, 0, -jMax, 0, jMax});
-    return profile.check(pf, vf, vMax, aMax);
+    valid.add_if_valid(profile, pf, vf, vMax, aMax);
 }
 
 bool RuckigStep2::time_up_acc1_vel(Profile& profile, double tf, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
@@ -115,6 +308,8 @@ bool RuckigStep2::time_up_acc1_vel(Profile& profile, double tf, double p0, doubl
 
         auto roots = Roots::solveQuart(polynom);
         for (double t: roots) {
+            t = Roots::polishRoot(polynom, t);
+
             profile.t[0] = t;
             profile.t[1] = 0;
             profile.t[2] = a0/jMax + t;
@@ -124,7 +319,7 @@ bool RuckigStep2::time_up_acc1_vel(Profile& profile, double tf, double p0, doubl
             profile.t[6] = profile.t[4];
             
             profile.set(p0, v0, a0, {jMax, 0, -jMax, 0, -jMax, 0, jMax});
-            if (profile.check(pf, vf, vMax, aMax)) {
+            if (profile.check(tf, pf, vf, vMax, aMax)) {
                 return true;
             }
         }
@@ -141,6 +336,8 @@ bool RuckigStep2::time_up_acc1_vel(Profile& profile, double tf, double p0, doubl
 
         auto roots = Roots::solveQuart(polynom);
         for (double t: roots) {
+            t = Roots::polishRoot(polynom, t);
+
             profile.t[0] = t;
             profile.t[1] = 0;
             profile.t[2] = a0/jMax + t;
@@ -150,7 +347,7 @@ bool RuckigStep2::time_up_acc1_vel(Profile& profile, double tf, double p0, doubl
             profile.t[6] = profile.t[4];
             
             profile.set(p0, v0, a0, {jMax, 0, -jMax, 0, jMax, 0, -jMax});
-            if (profile.check(pf, vf, vMax, aMax)) {
+            if (profile.check(tf, pf, vf, vMax, aMax)) {
                 return true;
             }
         }
@@ -159,7 +356,7 @@ bool RuckigStep2::time_up_acc1_vel(Profile& profile, double tf, double p0, doubl
     return false;
 }
 
-bool RuckigStep1::time_up_acc0_vel(Profile& profile, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
+void RuckigStep1::time_up_acc0_vel(Profile& profile, ValidProfiles& valid, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
     profile.t[0] = (-a0 + aMax)/jMax;
     profile.t[1] = (Power(a0,2) - 2*Power(aMax,2) + 2*jMax*(-v0 + vMax))/(2*aMax*jMax);
     profile.t[2] = aMax/jMax;
@@ -169,42 +366,35 @@ bool RuckigStep1::time_up_acc0_vel(Profile& profile, double p0, double v0, doubl
     profile.t[6] = profile.t[4];
 
     profile.set(p0, v0, a0, {jMax, 0, -jMax, 0, -jMax, 0, jMax});
-    return profile.check(pf, vf, vMax, aMax);
+    valid.add_if_valid(profile, pf, vf, vMax, aMax);
 }
 
 bool RuckigStep2::time_up_acc0_vel(Profile& profile, double tf, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
-    const double h1 = Power(a0,2) - 2*a0*aMax + Power(aMax,2) - 2*aMax*jMax*tf + 2*jMax*(-v0 + vf);
-    const double h2 = 3*Power(a0,4) - 8*Power(a0,3)*aMax + 24*a0*aMax*jMax*(v0 - vf) + 6*Power(a0,2)*(Power(aMax,2) + 2*jMax*(-v0 + vf)) - 12*jMax*(Power(aMax,2)*(v0 - vf) - jMax*Power(v0 - vf,2) + 2*aMax*jMax*(p0 - pf + tf*vf));
-    const double h3 = 144*(Power(h1,2) + h2)*Power(jMax,4);
-        
+    // The duration t of the last acceleration segments is the root of a quartic polynomial (with a vanishing linear coefficient)
+    const double h1 = (Power(a0 - aMax,2) - 2*aMax*jMax*tf - 2*jMax*(v0 - vf))/Power(jMax,2);
+    const double h2 = -(-3*Power(a0,4) + 8*Power(a0,3)*aMax - 6*Power(a0,2)*Power(aMax,2) + 12*jMax*(v0 - vf)*Power(a0 - aMax,2) + 24*aMax*Power(jMax,2)*(p0 - pf + tf*vf) - 12*Power(jMax,2)*Power(v0 - vf,2))/(12*Power(jMax,4));
+
     // Profile UDDU
     {
-        const double h4 = 1728*(2*Power(h1,3) + 9*Power(aMax,2)*h2 - 6*h1*h2)*Power(jMax,6);
-        const auto h5 = PowerComplex(h4 + SqrtComplex(-4*Power(h3,3) + Power(h4,2)),1./3);
-        const auto h6 = SqrtComplex((2*Power(2,1./3)*h3 + h5*(Power(2,2./3)*h5 + 24*(3*Power(aMax,2) - 2*h1)*Power(jMax,2)))/(h5*Power(jMax,4)))/(6.*Sqrt(2));
-        const auto h7 = (-2*(Power(aMax,3) - aMax*h1))/(h6*Power(jMax,3));
-        const auto h8 = -(2*Power(2,1./3)*h3 + h5*(Power(2,2./3)*h5 + 48*(-3*Power(aMax,2) + 2*h1)*Power(jMax,2)))/(72.*h5*Power(jMax,4));
+        const std::array<double, 5> polynom {1.0, 2*aMax/jMax, h1, 0.0, h2};
+        auto roots = Roots::solveQuart(polynom);
+        for (double t: roots) {
+            if (t < 0.0 || t > tf) {
+                continue;
+            }
+
+            t = Roots::polishRoot(polynom, t);
 
-        // Solution 3
-        {
             profile.t[0] = (-a0 + aMax)/jMax;
-            profile.t[1] = ((Power(a0,2)*aMax - 2*a0*aMax*(aMax - h6*jMax) - jMax*(PowerComplex(h6,2)*SqrtComplex(h7 + h8)*Power(jMax,2) + Power(aMax,2)*(h6 + 2*tf) + aMax*(PowerComplex(h6,2)*jMax - h6*jMax*(SqrtComplex(h7 + h8) + 2*tf) + 2*(v0 - vf))))/(2.*aMax*h6*Power(jMax,2))).real();
+            profile.t[1] = (Power(a0,2)/2 - Power(aMax,2) + Power(jMax,2)*Power(t,2) - jMax*(v0 - vf))/(aMax*jMax);
             profile.t[2] = aMax/jMax;
-            profile.t[3] = ((-(Power(a0,2)*aMax) + 2*a0*Power(aMax,2) + PowerComplex(h6,2)*SqrtComplex(h7 + h8)*Power(jMax,3) - Power(aMax,2)*jMax*(h6 - 2*tf) + aMax*jMax*(-(PowerComplex(h6,2)*jMax) + h6*SqrtComplex(h7 + h8)*jMax + 2*v0 - 2*vf))/(2.*aMax*h6*Power(jMax,2))).real();
-            profile.t[4] = -(aMax - h6*jMax + SqrtComplex(h7 + h8)*jMax).real()/(2.*jMax);
+            profile.t[3] = tf - profile.t[0] - profile.t[1] - profile.t[2] - 2*t;
+            profile.t[4] = t;
             profile.t[5] = 0;
-            profile.t[6] = profile.t[4];
+            profile.t[6] = t;
 
-            // std::cout << profile.t[0] << std::endl;
-            // std::cout << profile.t[1] << std::endl;
-            // std::cout << profile.t[2] << std::endl;
-            // std::cout << profile.t[3] << std::endl;
-            // std::cout << profile.t[4] << std::endl;
-            // std::cout << profile.t[5] << std::endl;
-            // std::cout << profile.t[6] << std::endl;
-            
             profile.set(p0, v0, a0, {jMax, 0, -jMax, 0, -jMax, 0, jMax});
-            if (profile.check(pf, vf, vMax, aMax)) {
+            if (profile.check(tf, pf, vf, vMax, aMax)) {
                 return true;
             }
         }
@@ -212,33 +402,25 @@ bool RuckigStep2::time_up_acc0_vel(Profile& profile, double tf, double p0, doubl
 
     // Profile UDUD
     {
-        const double h4 = 1728*(-2*Power(h1,3) + 9*Power(aMax,2)*h2 + 6*h1*h2)*Power(jMax,6);
-        const auto h5 = PowerComplex(h4 + SqrtComplex(-4*Power(h3,3) + Power(h4,2)),1./3);
-        const auto h6 = SqrtComplex((2*Power(2,0.3333333333333333)*h3 + h5*(Power(2,0.6666666666666666)*h5 + 24*(3*Power(aMax,2) + 2*h1)*Power(jMax,2)))/(h5*Power(jMax,4)))/(6.*Sqrt(2));
-        const auto h7 = (2*aMax*(Power(aMax,2) + h1))/(h6*Power(jMax,3));
-        const auto h8 = (-2*Power(2,0.3333333333333333)*h3 + h5*(-(Power(2,0.6666666666666666)*h5) + 48*(3*Power(aMax,2) + 2*h1)*Power(jMax,2)))/(72.*h5*Power(jMax,4));
+        const std::array<double, 5> polynom {1.0, -2*aMax/jMax, -h1, 0.0, h2};
+        auto roots = Roots::solveQuart(polynom);
+        for (double t: roots) {
+            if (t < 0.0 || t > tf) {
+                continue;
+            }
+
+            t = Roots::polishRoot(polynom, t);
 
-        // Solution 2
-        {
             profile.t[0] = (-a0 + aMax)/jMax;
-            profile.t[1] = ((Power(a0,2)*aMax + 2*Power(aMax,3) + PowerComplex(h6,2)*SqrtComplex(-h7 + h8)*Power(jMax,3) - 2*a0*aMax*(aMax - h6*jMax) - Power(aMax,2)*jMax*(5.*h6 + 2*tf) + aMax*jMax*(PowerComplex(h6,2)*jMax - h6*SqrtComplex(-h7 + h8)*jMax + 2.*h6*jMax*tf - 2*v0 + 2*vf))/(2.*aMax*h6*Power(jMax,2))).real();
+            profile.t[1] = (Power(a0,2)/2 - Power(aMax,2) - Power(jMax,2)*Power(t,2) - jMax*(v0 - vf))/(aMax*jMax);
             profile.t[2] = aMax/jMax;
-            profile.t[3] = (-(Power(a0,2)*aMax - 2*a0*Power(aMax,2) + 2*Power(aMax,3) + PowerComplex(h6,2)*SqrtComplex(-h7 + h8)*Power(jMax,3) + Power(aMax,2)*jMax*(h6 - 2*tf) + aMax*jMax*(-(PowerComplex(h6,2)*jMax) + h6*SqrtComplex(-h7 + h8)*jMax - 2*v0 + 2*vf))/(2.*aMax*h6*Power(jMax,2))).real();
-            profile.t[4] = (aMax - h6*jMax + SqrtComplex(-h7 + h8)*jMax).real()/(2.*jMax);
+            profile.t[3] = tf - profile.t[0] - profile.t[1] - profile.t[2] - 2*t;
+            profile.t[4] = t;
             profile.t[5] = 0;
-            profile.t[6] = profile.t[4];
+            profile.t[6] = t;
 
-            // std::cout << profile.t[0] << std::endl;
-            // std::cout << profile.t[1] << std::endl;
-            // std::cout << profile.t[2] << std::endl;
-            // std::cout << profile.t[3] << std::endl;
-            // std::cout << profile.t[4] << std::endl;
-            // std::cout << profile.t[5] << std::endl;
-            // std::cout << profile.t[6] << std::endl;
-            // std::cout << "---" << std::endl;
-            
             profile.set(p0, v0, a0, {jMax, 0, -jMax, 0, jMax, 0, -jMax});
-            if (profile.check(pf, vf, vMax, aMax)) {
+            if (profile.check(tf, pf, vf, vMax, aMax)) {
                 return true;
             }
         }
@@ -247,7 +429,7 @@ bool RuckigStep2::time_up_acc0_vel(Profile& profile, double tf, double p0, doubl
     return false;
 }
 
-bool RuckigStep1::time_up_vel(Profile& profile, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
+void RuckigStep1::time_up_vel(Profile& profile, ValidProfiles& valid, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
     profile.t[0] = ((-2*a0*jMax + Sqrt(2)*Sqrt(Power(a0,2) + 2*jMax*(-v0 + vMax))*Abs(jMax))/(2*Power(jMax,2)));
     profile.t[1] = 0;
     profile.t[2] = Sqrt(Power(a0,2)/2 + jMax*(-v0 + vMax))/Abs(jMax);
@@ -257,7 +439,7 @@ bool RuckigStep1::time_up_vel(Profile& profile, double p0, double v0, double a0,
     profile.t[6] = profile.t[4];
 
     profile.set(p0, v0, a0, {jMax, 0, -jMax, 0, -jMax, 0, jMax});
-    return profile.check(pf, vf, vMax, aMax);
+    valid.add_if_valid(profile, pf, vf, vMax, aMax);
 }
 
 bool RuckigStep2::time_up_vel(Profile& profile, double tf, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
@@ -274,7 +456,7 @@ bool RuckigStep2::time_up_vel(Profile& profile, double tf, double p0, double v0,
 
         // Solve 4th order derivative analytically
         auto extremas = Roots::solveQuart(5 * polynom[0], 4 * polynom[1], 3 * polynom[2], 2 * polynom[3], polynom[4]);
-        std::set<std::tuple<double, double>> tz_intervals;
+        Roots::Set<std::tuple<double, double>, 6> tz_intervals;
 
         double tz_min {0.0};
         double tz_max = std::min<double>(tf, (tf - a0/jMax) / 2);
@@ -329,7 +511,7 @@ bool RuckigStep2::time_up_vel(Profile& profile, double tf, double p0, double v0,
             // std::cout << "---" << std::endl;
 
             profile.set(p0, v0, a0, {jMax, 0, -jMax, 0, -jMax, 0, jMax});
-            if (profile.check(pf, vf, vMax, aMax)) {
+            if (profile.check(tf, pf, vf, vMax, aMax)) {
                 return true;
             }
         }
@@ -356,7 +538,7 @@ bool RuckigStep2::time_up_vel(Profile& profile, double tf, double p0, double v0,
         deriv[5] = polynom[5];
 
         auto dd_extremas = Roots::solveQuart(5 * deriv[0], 4 * deriv[1], 3 * deriv[2], 2 * deriv[3], deriv[4]);
-        std::set<std::tuple<double, double>> dd_tz_intervals;
+        Roots::Set<std::tuple<double, double>, 6> dd_tz_intervals;
 
         double tz_min {0.0};
         double tz_max = std::min<double>(tf, (tf - a0/jMax) / 2);
@@ -377,7 +559,7 @@ bool RuckigStep2::time_up_vel(Profile& profile, double tf, double p0, double v0,
             dd_tz_intervals.insert({dd_tz_current, tz_max});
         }
 
-        std::set<std::tuple<double, double>> tz_intervals;
+        Roots::Set<std::tuple<double, double>, 6> tz_intervals;
         double tz_current {tz_min};
 
         for (auto interval: dd_tz_intervals) {
@@ -418,7 +600,7 @@ bool RuckigStep2::time_up_vel(Profile& profile, double tf, double p0, double v0,
             // std::cout << profile.t[4] << " " << Sqrt((vf - vPlat)/jMax) << std::endl;
 
             profile.set(p0, v0, a0, {jMax, 0, -jMax, 0, jMax, 0, -jMax});
-            if (profile.check(pf, vf, vMax, aMax)) {
+            if (profile.check(tf, pf, vf, vMax, aMax)) {
                 return true;
             }
         }
@@ -427,19 +609,22 @@ bool RuckigStep2::time_up_vel(Profile& profile, double tf, double p0, double v0,
     return false;
 }
 
-bool RuckigStep1::time_up_acc0_acc1(Profile& profile, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
-    const double h1 = Abs(aMax)*Abs(jMax)*Sqrt(6*(3*Power(a0,4) - 8*Power(a0,3)*aMax + 24*a0*aMax*jMax*v0 + 6*Power(a0,2)*(Power(aMax,2) - 2*jMax*v0) + 6*(Power(aMax,4) + 4*aMax*Power(jMax,2)*(-p0 + pf) - 2*Power(aMax,2)*jMax*(v0 + vf) + 2*Power(jMax,2)*(Power(v0,2) + Power(vf,2)))));
+void RuckigStep1::time_up_acc0_acc1(Profile& profile, ValidProfiles& valid, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
+    const double h0 = Abs(aMax)*Abs(jMax)*Sqrt(6*(3*Power(a0,4) - 8*Power(a0,3)*aMax + 24*a0*aMax*jMax*v0 + 6*Power(a0,2)*(Power(aMax,2) - 2*jMax*v0) + 6*(Power(aMax,4) + 4*aMax*Power(jMax,2)*(-p0 + pf) - 2*Power(aMax,2)*jMax*(v0 + vf) + 2*Power(jMax,2)*(Power(v0,2) + Power(vf,2)))));
 
-    profile.t[0] = (-a0 + aMax)/jMax;
-    profile.t[1] = (6*Power(a0,2)*aMax*jMax - 18*Power(aMax,3)*jMax - 12*aMax*Power(jMax,2)*v0 + h1)/(12.*Power(aMax,2)*Power(jMax,2));
-    profile.t[2] = aMax/jMax;
-    profile.t[3] = 0;
-    profile.t[4] = profile.t[2];
-    profile.t[5] = (-18*Power(aMax,3)*jMax - 12*aMax*Power(jMax,2)*vf + h1)/(12.*Power(aMax,2)*Power(jMax,2));
-    profile.t[6] = profile.t[2];
+    // Both roots of the quadratic might give a valid profile
+    for (const double h1: {h0, -h0}) {
+        profile.t[0] = (-a0 + aMax)/jMax;
+        profile.t[1] = (6*Power(a0,2)*aMax*jMax - 18*Power(aMax,3)*jMax - 12*aMax*Power(jMax,2)*v0 + h1)/(12.*Power(aMax,2)*Power(jMax,2));
+        profile.t[2] = aMax/jMax;
+        profile.t[3] = 0;
+        profile.t[4] = profile.t[2];
+        profile.t[5] = (-18*Power(aMax,3)*jMax - 12*aMax*Power(jMax,2)*vf + h1)/(12.*Power(aMax,2)*Power(jMax,2));
+        profile.t[6] = profile.t[2];
 
-    profile.set(p0, v0, a0, {jMax, 0, -jMax, 0, -jMax, 0, jMax});
-    return profile.check(pf, vf, vMax, aMax);
+        profile.set(p0, v0, a0, {jMax, 0, -jMax, 0, -jMax, 0, jMax});
+        valid.add_if_valid(profile, pf, vf, vMax, aMax);
+    }
 }
 
 bool RuckigStep2::time_up_acc0_acc1(Profile& profile, double tf, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
@@ -454,7 +639,7 @@ bool RuckigStep2::time_up_acc0_acc1(Profile& profile, double tf, double p0, doub
         jMax = aMax/profile.t[0];
 
         profile.set(p0, v0, a0, {jMax, 0, -jMax, 0, -jMax, 0, jMax});
-        return profile.check(pf, vf, vMax, aMax);
+        return profile.check(tf, pf, vf, vMax, aMax);
     }
     
     double h1 = -12*(2*Power(aMax,3)*tf + Power(a0,2)*(aMax*tf - v0 + vf) - 2*a0*aMax*(aMax*tf - v0 + vf));
@@ -483,60 +668,40 @@ bool RuckigStep2::time_up_acc0_acc1(Profile& profile, double tf, double p0, doub
     // std::cout << jMax << std::endl;
 
     profile.set(p0, v0, a0, {jMax, 0, -jMax, 0, -jMax, 0, jMax});
-    return profile.check(pf, vf, vMax, aMax);
-}
-
-bool RuckigStep1::time_up_acc1(Profile& profile, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
-    const double h1 = 5*Power(a0,2) + 6*a0*aMax + Power(aMax,2) + 2*jMax*v0;
-    const double h2 = 2*a0 + aMax;
-    const double h3 = 3*Power(a0,4) + 8*Power(a0,3)*aMax + 24*a0*aMax*jMax*v0 + 6*Power(a0,2)*(Power(aMax,2) + 2*jMax*v0) + 12*jMax*(2*aMax*jMax*(p0 - pf) + Power(aMax,2)*(v0 + vf) + jMax*(Power(v0,2) - Power(vf,2)));
-    const double h4 = (a0 + aMax)*(Power(a0,2) + a0*aMax + 2*jMax*v0);
-    const double h5 = 4*Power(a0,4) + 8*Power(a0,3)*aMax + Power(aMax,4) + 24*aMax*Power(jMax,2)*(p0 - pf) - 24*a0*aMax*jMax*v0 + 4*Power(a0,2)*(Power(aMax,2) - 4*jMax*v0) + Power(aMax,2)*jMax*(-8*v0 + 12*vf) + 4*Power(jMax,2)*(4*Power(v0,2) - 3*Power(vf,2));
-    const double h6 = (2*Power(h1,3) - 6*h1*(h3 + 6*h2*h4) + 9*(Power(h2,2)*h3 + 12*Power(h4,2)));
-    const auto h7 = 12*Power(jMax,2)*PowerComplex(h6 + SqrtComplex(Power(h6,2) - 4*Power(h5,3)),1./3);
-    const auto h8 = SqrtComplex((4*Power(2,1./3)*h5)/h7 + (Power(2,2./3)*h7 + 24*(-2*h1 + 3*Power(h2,2))*Power(jMax,2))/(72.*Power(jMax,4)));
-    const auto h9 = SqrtComplex((-576*Power(2,1./3)*h5)/h7 - (2*Power(2,2./3)*h7)/Power(jMax,4) - (96.*(h1*(3*h2 + 2.*h8*jMax) - 3.*(Power(h2,3) + 2*h4 + Power(h2,2)*h8*jMax)))/(h8*Power(jMax,3)));
-    const auto h10 = SqrtComplex((-576*Power(2,1./3)*h5)/h7 - (2*Power(2,2./3)*h7)/Power(jMax,4) + (96.*(3*h1*h2 - 3*Power(h2,3) - 6*h4 - 2.*h1*h8*jMax + 3*Power(h2,2)*h8*jMax))/(h8*Power(jMax,3)));
-
-    // Solution 2
-    {
-        profile.t[0] = -h2/(2*jMax) + (h9 - 12.*h8).real()/24.;
-        profile.t[1] = 0;
-        profile.t[2] = -aMax/(2*jMax) + (h9 - 12.*h8).real()/24.;
-        profile.t[3] = 0;
-        profile.t[4] = aMax/jMax;
-        profile.t[5] = -((12*Power(a0,2)*aMax + jMax*(12*Power(aMax,2)*h8 + aMax*(-12.*PowerComplex(h8,2)*jMax + h8*jMax*h9 - 24*v0) + h8*jMax*(h8*jMax*h9 + 24*vf)))/(24.*aMax*h8*Power(jMax,2))).real();
-        profile.t[6] = profile.t[4];
-
-        profile.t[2] = (profile.t[2] + profile.t[4]) / 2;
-        profile.t[4] = profile.t[2];
+    return profile.check(tf, pf, vf, vMax, aMax);
+}
 
-        profile.set(p0, v0, a0, {jMax, 0, -jMax, 0, -jMax, 0, jMax});
-        if (profile.check(pf, vf, vMax, aMax)) {
-            return true;
+void RuckigStep1::time_up_acc1(Profile& profile, ValidProfiles& valid, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
+    // The duration t of the first segment is a root of a quartic polynomial, all of its roots might give a valid profile
+    std::array<double, 5> polynom;
+    polynom[0] = 1.0;
+    polynom[1] = (2*(2*a0 + aMax))/jMax;
+    polynom[2] = (5*Power(a0,2) + 6*a0*aMax + Power(aMax,2) + 2*jMax*v0)/Power(jMax,2);
+    polynom[3] = (2*(a0 + aMax)*(Power(a0,2) + a0*aMax + 2*jMax*v0))/Power(jMax,3);
+    polynom[4] = (3*Power(a0,4) + 8*Power(a0,3)*aMax + 6*Power(a0,2)*Power(aMax,2) + 12*jMax*(Power(a0,2)*v0 + 2*a0*aMax*v0 + Power(aMax,2)*(v0 + vf) + 2*aMax*jMax*(p0 - pf) + jMax*(Power(v0,2) - Power(vf,2))))/(12*Power(jMax,4));
+
+    auto roots = Roots::solveQuart(polynom);
+    for (double t: roots) {
+        if (t < 0.0) {
+            continue;
         }
-    }
 
-    // Solution 4
-    {
-        profile.t[0] = -h2/(2.*jMax) + (h10 + 12.*h8).real()/24.;
+        t = Roots::polishRoot(polynom, t);
+
+        // Split the second segment where the acceleration crosses zero, so that the velocity limit is checked at its extremum
+        const double a_peak = a0 + jMax*t;
+
+        profile.t[0] = t;
         profile.t[1] = 0;
-        profile.t[2] = -aMax/(2.*jMax) + (h10 + 12.*h8).real()/24.;
+        profile.t[2] = (a_peak/jMax > 0) ? a_peak/jMax : (a_peak + aMax)/jMax;
         profile.t[3] = 0;
-        profile.t[4] = aMax/jMax;
-        profile.t[5] = -(Power(aMax,2) + aMax*(-(Power(a0,2)/(h8*jMax)) + h10*jMax/12. + h8*jMax + (2*v0)/h8) + jMax*(-(h10*h8*jMax)/12. + 2*vf)).real()/(2.*aMax*jMax);
-        profile.t[6] = profile.t[4];
-
-        profile.t[2] = (profile.t[2] + profile.t[4]) / 2;
-        profile.t[4] = profile.t[2];
+        profile.t[4] = (a_peak/jMax > 0) ? aMax/jMax : 0;
+        profile.t[5] = (Power(a0,2)/2 - Power(aMax,2) + Power(jMax,2)*Power(t,2) + jMax*(2*a0*t + v0 - vf))/(aMax*jMax);
+        profile.t[6] = aMax/jMax;
 
         profile.set(p0, v0, a0, {jMax, 0, -jMax, 0, -jMax, 0, jMax});
-        if (profile.check(pf, vf, vMax, aMax)) {
-            return true;
-        }
+        valid.add_if_valid(profile, pf, vf, vMax, aMax);
     }
-
-    return false;
 }
 
 bool RuckigStep2::time_up_acc1(Profile& profile, double tf, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
@@ -552,7 +717,7 @@ bool RuckigStep2::time_up_acc1(Profile& profile, double tf, double p0, double v0
         profile.t[6] = (aMax/jMax);
 
         profile.set(p0, v0, a0, {jMax, 0, -jMax, 0, -jMax, 0, jMax});
-        if (profile.check(pf, vf, vMax, aMax)) {
+        if (profile.check(tf, pf, vf, vMax, aMax)) {
             return true;
         }
     }
@@ -568,101 +733,41 @@ bool RuckigStep2::time_up_acc1(Profile& profile, double tf, double p0, double v0
         profile.t[6] = (aMax/jMax);
 
         profile.set(p0, v0, a0, {jMax, 0, -jMax, 0, jMax, 0, -jMax});
-        if (profile.check(pf, vf, vMax, aMax)) {
+        if (profile.check(tf, pf, vf, vMax, aMax)) {
             return true;
         }
     }
     return false;
 }
 
-bool RuckigStep1::time_up_acc0(Profile& profile, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
-    if (std::abs(vf) < 1e-16) {
-        const auto h1 = Sqrt(3)*SqrtComplex(-3*Power(a0,4) + 8*Power(a0,3)*aMax - 24*a0*aMax*jMax*v0 - 6*Power(a0,2)*(Power(aMax,2) - 2*jMax*v0) + 12*jMax*(2*aMax*jMax*(p0 - pf) + Power(aMax,2)*v0 - jMax*Power(v0,2)));
-        const auto h2 = SqrtComplex(9*Power(aMax,2) - Complex(0,6)*h1);
-
-        // Solution 2
-        {
-            profile.t[0] = (-a0 + aMax)/jMax;
-            profile.t[1] = (3*Power(a0,2) - 3*Power(aMax,2) - 6*jMax*v0 - Complex(0,1)*h1 - aMax*h2).real()/(6.*aMax*jMax);
-            profile.t[2] = aMax/jMax;
-            profile.t[3] = 0;
-            profile.t[4] = (-3*aMax + h2.real())/(6.*jMax);
-            profile.t[5] = 0;
-            profile.t[6] = profile.t[4];
-
-            profile.set(p0, v0, a0, {jMax, 0, -jMax, 0, -jMax, 0, jMax});
-            if (profile.check(pf, vf, vMax, aMax)) {
-                return true;
-            }
+void RuckigStep1::time_up_acc0(Profile& profile, ValidProfiles& valid, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
+    // The duration t of the last two segments is a root of a quartic polynomial, all of its roots might give a valid profile
+    std::array<double, 5> polynom;
+    polynom[0] = 1.0;
+    polynom[1] = (2*aMax)/jMax;
+    polynom[2] = (Power(aMax,2) + 2*jMax*vf)/Power(jMax,2);
+    polynom[3] = (4*aMax*vf)/Power(jMax,2);
+    polynom[4] = (-3*Power(a0,4) + 8*Power(a0,3)*aMax - 6*Power(a0,2)*Power(aMax,2) + 12*jMax*(Power(a0,2)*v0 - 2*a0*aMax*v0 + Power(aMax,2)*(v0 + vf) + 2*aMax*jMax*(p0 - pf) - jMax*(Power(v0,2) - Power(vf,2))))/(12*Power(jMax,4));
+
+    auto roots = Roots::solveQuart(polynom);
+    for (double t: roots) {
+        if (t < 0.0) {
+            continue;
         }
 
-        // Solution 1
-        {
-            profile.t[0] = (-a0 + aMax)/jMax;
-            profile.t[1] = (3*Power(a0,2) - 3*Power(aMax,2) - 6*jMax*v0 - Complex(0,1)*h1 + aMax*h2).real()/(6.*aMax*jMax);
-            profile.t[2] = aMax/jMax;
-            profile.t[3] = 0;
-            profile.t[4] = -(3*aMax + h2.real())/(6.*jMax);
-            profile.t[5] = 0;
-            profile.t[6] = profile.t[4];
-
-            profile.set(p0, v0, a0, {jMax, 0, -jMax, 0, -jMax, 0, jMax});
-            if (profile.check(pf, vf, vMax, aMax)) {
-                return true;
-            }
-        }
+        t = Roots::polishRoot(polynom, t);
 
-        return false;
-    }
-
-    const double h1 = Power(aMax,2) + 2*jMax*vf;
-    const double h2 = 3*Power(a0,4) - 8*Power(a0,3)*aMax + 24*a0*aMax*jMax*v0 + 6*Power(a0,2)*(Power(aMax,2) - 2*jMax*v0) - 12*jMax*(2*aMax*jMax*(p0 - pf) + Power(aMax,2)*(v0 + vf) + jMax*(-Power(v0,2) + Power(vf,2)));
-    const double h3 = Power(jMax,4)*(-3*Power(a0,4) + 8*Power(a0,3)*aMax + Power(aMax,4) + 24*aMax*Power(jMax,2)*(p0 - pf) - 24*a0*aMax*jMax*v0 - 6*Power(a0,2)*(Power(aMax,2) - 2*jMax*v0) + 4*Power(aMax,2)*jMax*(3*v0 - 2*vf) + 4*Power(jMax,2)*(-3*Power(v0,2) + 4*Power(vf,2)));
-    const double h4 = 1728*Power(jMax,6)*(-2*Power(h1,3) - 6*h1*(h2 - 12*Power(aMax,2)*jMax*vf) + 9*Power(aMax,2)*(h2 - 48*Power(jMax,2)*Power(vf,2)));
-    const auto h5 = Power(h4 + Sqrt(-11943936*Power(h3,3) + Power(h4,2)),1./3);
-    const auto h6 = SqrtComplex((-4*Power(2,1./3)*h3)/(h5*Power(jMax,4)) - h5/(36.*Power(2,1./3)*Power(jMax,4)) + Power(aMax,2)/Power(jMax,2) - (2*h1)/(3.*Power(jMax,2)));
-    const auto h7 = SqrtComplex((288*Power(2,1./3)*h3*h6 + h5*(Power(2,2./3)*h5*h6 + 48*jMax*(3*Power(aMax,3) - 3*aMax*h1 + 3*Power(aMax,2)*h6*jMax - 2*h1*h6*jMax + 12*aMax*jMax*vf)))/(h5*h6))/(6.*Sqrt(2)*Power(Abs(jMax),2));
-    const auto h8 = SqrtComplex((288*Power(2,1./3)*h3*h6 + h5*(Power(2,2./3)*h5*h6 + 48*jMax*(-3*Power(aMax,3) + 3*Power(aMax,2)*h6*jMax - 2*h1*h6*jMax + 3*aMax*(h1 - 4*jMax*vf))))/(h5*h6))/(6.*Sqrt(2)*Power(Abs(jMax),2));
-
-    // Solution 2
-    {
         profile.t[0] = (-a0 + aMax)/jMax;
-        profile.t[1] = -(-Power(a0,2) + Power(aMax,2) + jMax*(h6*h7*jMax + 2*v0) + aMax*(-h6*jMax + h7*jMax - (2*vf)/h6)).real()/(2.*aMax*jMax);
+        profile.t[1] = (Power(a0,2)/2 - Power(aMax,2) + Power(jMax,2)*Power(t,2) - jMax*(v0 - vf))/(aMax*jMax);
         profile.t[2] = aMax/jMax;
         profile.t[3] = 0;
-        profile.t[4] = (-aMax/jMax - h6 + h7).real()/2;
+        profile.t[4] = t;
         profile.t[5] = 0;
-        profile.t[6] = profile.t[4];
-
-        profile.t[2] = (profile.t[2] + profile.t[4]) / 2;
-        profile.t[4] = profile.t[2];
+        profile.t[6] = t;
 
         profile.set(p0, v0, a0, {jMax, 0, -jMax, 0, -jMax, 0, jMax});
-        if (profile.check(pf, vf, vMax, aMax)) {
-            return true;
-        }
+        valid.add_if_valid(profile, pf, vf, vMax, aMax);
     }
-
-    // Solution 4
-    {
-        profile.t[0] = (-a0 + aMax)/jMax;
-        profile.t[1] = -(-Power(a0,2) + Power(aMax,2) + jMax*(-(h6*h8*jMax) + 2*v0) + aMax*(h6*jMax + h8*jMax + (2*vf)/h6)).real()/(2.*aMax*jMax);
-        profile.t[2] = aMax/jMax;
-        profile.t[3] = 0;
-        profile.t[4] = (-aMax/jMax + h6 + h8).real()/2;
-        profile.t[5] = 0;
-        profile.t[6] = profile.t[4];
-
-        profile.t[2] = (profile.t[2] + profile.t[4]) / 2;
-        profile.t[4] = profile.t[2];
-
-        profile.set(p0, v0, a0, {jMax, 0, -jMax, 0, -jMax, 0, jMax});
-        if (profile.check(pf, vf, vMax, aMax)) {
-            return true;
-        }
-    }
-
-    return false;
 }
 
 bool RuckigStep2::time_up_acc0(Profile& profile, double tf, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
@@ -678,258 +783,55 @@ bool RuckigStep2::time_up_acc0(Profile& profile, double tf, double p0, double v0
     profile.t[6] = 0;
 
     profile.set(p0, v0, a0, {jMax, 0, -jMax, 0, -jMax, 0, jMax});
-    if (profile.check(pf, vf, vMax, aMax)) {
+    if (profile.check(tf, pf, vf, vMax, aMax)) {
         return true;
     }
 
     return false;
 }
 
-bool RuckigStep1::time_up_none(Profile& profile, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
-    if (std::abs(v0) < 1e-14 && std::abs(a0) < 1e-14 && std::abs(vf) < 1e-14) {
-        profile.t[0] = Power((pf - p0)/(2*jMax),1./3);
-        profile.t[1] = 0;
-        profile.t[2] = profile.t[0];
-        profile.t[3] = 0;
-        profile.t[4] = profile.t[0];
-        profile.t[5] = 0;
-        profile.t[6] = profile.t[0];
-
-        profile.set(p0, v0, a0, {jMax, 0, -jMax, 0, -jMax, 0, jMax});
-        return profile.check(pf, vf, vMax, aMax);
-    }
-
-    if (std::abs(a0) < 1e-14 && std::abs(p0 - pf) < 1e-14) {
-        // Solution 2
-
-        profile.t[0] = Sqrt((1 + Sqrt(5))/2.)*Sqrt(-(v0/jMax));
-        profile.t[1] = 0;
-        profile.t[2] = profile.t[0];
-        profile.t[3] = 0;
-        profile.t[4] = ((-1 + Sqrt(5))*Sqrt((1 + Sqrt(5))/2.)*Sqrt(-(v0/jMax)))/2;
-        profile.t[5] = 0;
-        profile.t[6] = profile.t[4];
-
-        profile.set(p0, v0, a0, {jMax, 0, -jMax, 0, -jMax, 0, jMax});
-        return profile.check(pf, vf, vMax, aMax);
-    }
-
-    if (std::abs(a0) < 1e-14 && std::abs(vf) < 1e-14 && std::abs(p0 - pf) < 2e-5) {
-        // Solution 2, plus epsilon in timing
-
-        double h4 = Sqrt(1 + Sqrt(5));
-        double h1 = (16*(27*jMax*Power(p0 - pf,2) + 26*Power(v0,3)))/Power(jMax,3);
-        auto h2 = PowerComplex(h1 + SqrtComplex(Power(h1,2) - (256*Power(v0,6))/Power(jMax,6)),1./3);
-        double h3 = Sqrt(-(v0/jMax));
-        double h5 = (2*(-4*(4 + 3*Sqrt(5)) + Power(h4,6))*v0)/jMax;
-        double h6 = (8.*(-4*p0 + 4*pf + Sqrt(2)*(5 + Sqrt(5))*h3*h4*v0))/jMax;
-        auto h7 = (Power(2,2./3)*h2 - (16*v0)/jMax + (8*Power(2,1./3)*Power(v0,2))/(h2*Power(jMax,2)))/6.;
-        auto h8 = (-(Sqrt(2)*h3*Power(h4,3)) + 2.*SqrtComplex(h7) + SqrtComplex((Sqrt(2)*h3*Power(h4,3)*h5 + h6)/SqrtComplex(h7) - 4.*h7 + (16*(4 + 3*Sqrt(5))*v0)/jMax - (6*(1 + Sqrt(5))*Power(h4,4)*v0)/jMax))/4.;
-
-        auto eps1 = -(3*Sqrt(2)*(1 + Sqrt(5))*h3*h4*PowerComplex(h8,2)*jMax + 4.*(PowerComplex(h8,3)*jMax + 4*(p0 - pf) - 3.*h8*v0*(1 + Sqrt(5))))/(8.*v0);
-        auto eps2 = h8;
-        auto eps4 = (3*Sqrt(2)*(1 + Sqrt(5))*h3*h4*PowerComplex(h8,2)*jMax + 4.*PowerComplex(h8,3)*jMax + 16*(p0 - pf) - 4.*h8*v0*(1 + 3*Sqrt(5)))/(8.*v0);
-
-        profile.t[0] = Sqrt((1 + Sqrt(5))/2.)*h3 + eps1.real();
-        profile.t[1] = 0;
-        profile.t[2] = profile.t[0] - eps1.real() + eps2.real();
-        profile.t[3] = 0;
-        profile.t[4] = ((-1 + Sqrt(5))*Sqrt((1 + Sqrt(5))/2.)*h3)/2;
-        profile.t[5] = 0;
-        profile.t[6] = profile.t[4] + eps4.real();
-
-        profile.set(p0, v0, a0, {jMax, 0, -jMax, 0, -jMax, 0, jMax});
-        return profile.check(pf, vf, vMax, aMax);
-    }
+void RuckigStep1::time_up_none(Profile& profile, ValidProfiles& valid, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
+    // The duration t of the last segment is a root of a quartic polynomial, or of a cubic one if the leading coefficient vanishes.
+    // The peak acceleration after the first segment follows from t up to its sign, so that both signs are checked.
+    const double h1 = Power(a0,2)/2 - jMax*(v0 - vf);
+    const double h2 = Power(a0,3) - 3*a0*jMax*v0 + 3*Power(jMax,2)*(p0 - pf);
+    const double h3 = 2*jMax*(v0 + vf) - Power(a0,2);
+
+    std::array<double, 5> polynom;
+    polynom[0] = h1;
+    polynom[1] = (2*h2)/(3*jMax);
+    polynom[2] = Power(h1,2)/Power(jMax,2);
+    polynom[3] = (4*h2*vf)/(3*Power(jMax,2));
+    polynom[4] = Power(h2,2)/(9*Power(jMax,4)) - (h1*Power(h3,2))/(4*Power(jMax,4));
+
+    const bool is_cubic = std::abs(polynom[0]) < 1e-12 * std::abs(polynom[1]);
+    const auto roots = is_cubic ? Roots::Set<double, 4>(Roots::solveCub(polynom[1], polynom[2], polynom[3], polynom[4])) : Roots::solveQuart(polynom);
+    for (double t: roots) {
+        if (t < 0.0) {
+            continue;
+        }
 
-    if (std::abs(v0) < 1e-14 && std::abs(vf) < 1e-14) {
-        // Solution 2
-        {
-            const double h1 = Power(a0,3) + 3*Power(jMax,2)*(p0 - pf);
-            const double h2 = -Power(a0,8) + 192*Power(a0,5)*Power(jMax,2)*(p0 - pf) + 288*Power(a0,2)*Power(jMax,4)*Power(p0 - pf,2);
-            const double h3 = Power(a0,2)*jMax*(Power(a0,3) + 3*Power(jMax,2)*(p0 - pf));
-            const double h4 = 17*Power(a0,6) + 48*Power(a0,3)*Power(jMax,2)*(p0 - pf) + 72*Power(jMax,4)*Power(p0 - pf,2);
-            const double h5 = 3*(-576*Power(a0,2)*Power(h3,2) + 96*Power(a0,4)*h1*h3*jMax + 3*Power(a0,12)*Power(jMax,2) + (12*Power(a0,6) + 16*Power(h1,2))*h4*Power(jMax,2));
-            const double h6 = 6*Power(3*Power(jMax,4)*(h5 + Sqrt(Power(h5,2) - 3*Power(h2,3)*Power(jMax,4))),1./3);
-            const double h7 = (h2/h6 + h6/(108.*Power(jMax,4)))/Power(a0,2);
-            const double h8 = Sqrt(-9*h7 + (3*Power(a0,6) + 4*Power(h1,2))/(Power(a0,4)*Power(jMax,2)))/3.;
-            const double h9 = (8*h1*(-27 + (8*Power(h1,2))/Power(a0,6)))/(27.*Power(jMax,3));
-            const double h10 = (-6*h8 + Sqrt(36*h7 - (9*h9)/h8 + (8*(3*Power(a0,6) + 4*Power(h1,2)))/(Power(a0,4)*Power(jMax,2))) + (4*h1)/(Power(a0,2)*jMax))/12.;
-
-            profile.t[0] = (-6*h8 + Sqrt(36*h7 - (9*h9)/h8 + (8*(3*Power(a0,6) + 4*Power(h1,2)))/(Power(a0,4)*Power(jMax,2))) - (8*a0)/jMax + (12*jMax*(p0 - pf))/Power(a0,2))/12.;
-            profile.t[1] = 0;
-            profile.t[2] = h10;
-            profile.t[3] = 0;
-            profile.t[4] = (-12*Power(a0,7) + 17*Power(a0,6)*h10*jMax + 12*Power(a0,5)*Power(h10,2)*Power(jMax,2) - 18*Power(a0,4)*Power(jMax,2)*(Power(h10,3)*jMax + 2*p0 - 2*pf) + 48*Power(a0,3)*h10*Power(jMax,3)*(p0 - pf) + 36*Power(a0,2)*Power(h10,2)*Power(jMax,4)*(p0 - pf) + 72*h10*Power(jMax,5)*Power(p0 - pf,2))/(-(Power(a0,6)*jMax) + 48*Power(a0,3)*Power(jMax,3)*(p0 - pf) + 72*Power(jMax,5)*Power(p0 - pf,2));
-            profile.t[5] = 0;
-            profile.t[6] = profile.t[4];
+        t = Roots::polishRoot(polynom, t);
 
-            profile.set(p0, v0, a0, {jMax, 0, -jMax, 0, -jMax, 0, jMax});
-            if (profile.check(pf, vf, vMax, aMax)) {
-                return true;
-            }
+        const double h4 = Power(jMax,2)*Power(t,2) + h1;
+        if (h4 < 0.0) {
+            continue;
         }
-    }
 
-    if (std::abs(a0) < 1e-14 && std::abs(vf) < 1e-14) {
-        // Solution 2
-        {
-            const double h1 = jMax*Power(p0 - pf,2) - Power(v0,3);
-            const double h2 = p0 - pf;
-            const double h3 = 2*Power(jMax,3)*(54*h1*Power(h2,2)*jMax - 36*h1*Power(v0,3) + 180*Power(h2,2)*jMax*Power(v0,3) + Power(v0,6));
-            const double h4 = -(Power(jMax,2)*v0*(12*jMax*Power(p0 - pf,2) + 11*Power(v0,3)));
-            const double h5 = Power(h3 + Sqrt(Power(h3,2) - 4*Power(h4,3)),1./3);
-            // Be careful of numerical stability of h6
-            const long double h6 = (2*PowerLong(2,1./3)*h4 + PowerLong(2,2./3)*PowerLong(h5,2))/(6.*h5*PowerLong(jMax,2)*v0);
-            const long double h7 = PowerLong(h2,2)/PowerLong(v0,2) - (2*v0)/(3.*jMax);
-            const long double h8 = (-24*h2)/jMax - (8*PowerLong(h2,3))/PowerLong(v0,3);
-            const auto h9 = SqrtComplexLong(-h6 + 2*h7 - h8/(4.l*SqrtComplexLong(h6 + h7)));
-            const auto h10_c = -((long double)h2/v0 + SqrtComplexLong(h6 + h7) - h9)/(2.l);
-            const double h10 = h10_c.real();
-
-            profile.t[0] = h10;
+        // Split the second segment where the acceleration crosses zero, so that the velocity limit is checked at its extremum
+        for (const double a_peak: {Sqrt(h4), -Sqrt(h4)}) {
+            profile.t[0] = (a_peak - a0)/jMax;
             profile.t[1] = 0;
-            profile.t[2] = (-p0 + pf + (-SqrtComplexLong(h6 + h7) + h9).real()*v0)/(2*v0);
+            profile.t[2] = (a_peak/jMax > 0) ? a_peak/jMax : a_peak/jMax + t;
             profile.t[3] = 0;
-            profile.t[4] = (Power(h10,2)*jMax*(-p0 + pf)*v0 - Power(h10,3)*jMax*Power(v0,2) + 2*(-p0 + pf)*Power(v0,2) + h10*(jMax*Power(p0 - pf,2) - Power(v0,3)))/(jMax*Power(p0 - pf,2) + Power(v0,3));
+            profile.t[4] = (a_peak/jMax > 0) ? t : 0;
             profile.t[5] = 0;
-            profile.t[6] = profile.t[4];
+            profile.t[6] = t;
 
             profile.set(p0, v0, a0, {jMax, 0, -jMax, 0, -jMax, 0, jMax});
-            if (profile.check(pf, vf, vMax, aMax)) {
-                return true;
-            }
+            valid.add_if_valid(profile, pf, vf, vMax, aMax);
         }
     }
-
-    double h1 = 2*Power(a0,3) - 3*Power(jMax,2)*(p0 - pf) - 3.*a0*jMax*(v0 - 2*vf);
-    long double h2 = PowerLong(a0,2) - 2.l*jMax*(v0 - vf);
-    long double h3 = PowerLong(a0,5) - 24*PowerLong(a0,2)*PowerLong(jMax,2)*(p0 - pf) - 24*PowerLong(jMax,3)*(p0 - pf)*v0 + 4*PowerLong(a0,3)*jMax*(v0 + 3*vf) + 12*a0*PowerLong(jMax,2)*(PowerLong(v0,2) + 2*v0*vf - PowerLong(vf,2));
-    long double h4 = 3*PowerLong(a0,4) - 24*a0*PowerLong(jMax,2)*(p0 - pf) - 4*PowerLong(jMax,2)*PowerLong(v0 - vf,2) + 4*PowerLong(a0,2)*jMax*(v0 + 5*vf);
-    long double h5 = PowerLong(a0,6) - 48*PowerLong(a0,3)*PowerLong(jMax,2)*(p0 - pf) - 144*a0*PowerLong(jMax,3)*(p0 - pf)*v0 + 6*PowerLong(a0,4)*jMax*(v0 + 3*vf) + 36*PowerLong(a0,2)*PowerLong(jMax,2)*(PowerLong(v0,2) + 2*v0*vf - PowerLong(vf,2)) - 72*PowerLong(jMax,3)*(jMax*PowerLong(p0 - pf,2) - (v0 - vf)*PowerLong(v0 + vf,2));
-    long double h17 = jMax*(-PowerLong(a0,6) + 48*PowerLong(a0,3)*PowerLong(jMax,2)*(p0 - pf) - 144*a0*PowerLong(jMax,3)*(p0 - pf)*v0 + 6*PowerLong(a0,4)*jMax*(v0 - 3*vf) - 36*PowerLong(a0,2)*PowerLong(jMax,2)*(PowerLong(v0,2) - 2*v0*vf - PowerLong(vf,2)) + 72*PowerLong(jMax,3)*(jMax*PowerLong(p0 - pf,2) + PowerLong(v0 - vf,2)*(v0 + vf)));
-    long double h6 = -PowerLong(a0,8) + 192*PowerLong(a0,5)*PowerLong(jMax,2)*(p0 - pf) + 8*PowerLong(a0,6)*jMax*(v0 - 5*vf) + 1152*a0*PowerLong(jMax,4)*(p0 - pf)*v0*(v0 + vf) - 192*PowerLong(a0,3)*PowerLong(jMax,3)*(p0 - pf)*(5*v0 + 2*vf) - 120*PowerLong(a0,4)*PowerLong(jMax,2)*(PowerLong(v0,2) - 2*v0*vf - 3*PowerLong(vf,2)) + 96*PowerLong(a0,2)*PowerLong(jMax,3)*(3*jMax*PowerLong(p0 - pf,2) + 5*PowerLong(v0,3) - 3*PowerLong(v0,2)*vf - 15*v0*PowerLong(vf,2) + PowerLong(vf,3)) - 48*PowerLong(jMax,4)*(12*jMax*PowerLong(p0 - pf,2)*(v0 + vf) + PowerLong(v0 - vf,2)*(11*PowerLong(v0,2) + 26.l*v0*vf + 11*PowerLong(vf,2)));
-    long double h8 = 4*PowerLong(h1,2)/(9*h2) - h4/3;
-    long double h9 = -2*(h3 - h1*h4/h2 + PowerLong(2*h1,3)/PowerLong(3*h2,2))/3;
-    long double h7 = 3*(36*h2*PowerLong(h3,2) + 4*PowerLong(2*h1,2)*h5 + 3*h4*(PowerLong(h4,2) - 8*h1*h3 - 4*h2*h5));
-
-    // Important: Numerical stability of h10
-    const auto h10_x = PowerLong(h6,3)/PowerLong(h7,2);
-    std::complex<long double> h10 = PowerComplexLong(3 * h7 * (1.l - SqrtComplexLong(1.l - 3.l*h10_x)),1./3);
-    if (std::abs(h10_x) < 1e-7) {
-        h10 = PowerComplexLong(h10_x,1./3)*PowerComplexLong(9*h7/2,1./3) + PowerComplexLong(h10_x,4./3)*PowerComplexLong(9*h7/2,1./3)/4.l + 5.l*PowerComplexLong(h10_x,7./3)*PowerComplexLong(9*h7/2,1./3)/16.l;
-    }
-
-    const auto h11 = (h6/h10 + h10/3.l)/6.l;
-    const auto h12 = SqrtComplexLong((h2*(h10 - 3.l*(2*h4 - h6/h10)) + 2*PowerLong(2*h1,2))/18.l)/h2;
-
-    // std::cout << std::setprecision(15) << "---" << std::endl;
-    // std::cout << "h1-6: " << h1 << " " << h2 << " " << h3 << " " << h4 << " " << h5 << " " << h6 << std::endl;
-    // std::cout << "h7-12: " << h7 << " " << h8 << " " << h9 << " " << h10 << " " << h11 << " " << h12 << std::endl;
-
-    const auto h12_a = SqrtComplexLong((2*h8 - h11 + h9/h12)/h2);
-    const auto h12_b = SqrtComplexLong((2*h8 - h11 - h9/h12)/h2);
-
-    const auto h13_c = (h12 - h12_a)/(2.l*jMax) - h1/(3*h2*jMax);
-    const auto h14_c = (h12 + h12_a)/(2.l*jMax) - h1/(3*h2*jMax);
-    const auto h15_c = (-h12 + h12_b)/(2.l*jMax) - h1/(3*h2*jMax);
-    const auto h16_c = (-h12 - h12_b)/(2.l*jMax) - h1/(3*h2*jMax);
-    // std::cout << "h13-16: " << h13_c << " " << h14_c << " " << h15_c << " " << h16_c << std::endl;
-
-    // Solution 3
-    if (h13_c.real() > 0.0 && std::abs(h13_c.imag()) < 2e-8) {
-        const double h13 = std::abs(h13_c);
-
-        profile.t[0] = h13;
-        profile.t[1] = 0;
-        profile.t[2] = (-4*PowerLong(a0,3) + 3.l*((h2*(h12 - h12_a)) + 2*PowerLong(jMax,2)*(p0 - pf)) + 6l*a0*(h2 + jMax*(v0 - 2*vf))).real()/(6.l*h2*jMax);
-        profile.t[3] = 0;
-        profile.t[4] = -((Power(a0,7) + 13*Power(a0,6)*h13*jMax + 72*Power(jMax,4)*(-(h13*(jMax*Power(p0 - pf,2) - Power(v0 - vf,3))) + Power(h13,2)*jMax*(p0 - pf)*(v0 - vf) + 2*(p0 - pf)*v0*(v0 - vf) + Power(h13,3)*jMax*Power(v0 - vf,2)) + 6*Power(a0,5)*jMax*(7*Power(h13,2)*jMax + v0 + 3*vf) - 12*Power(a0,3)*Power(jMax,2)*(10*h13*jMax*(p0 - pf) - Power(v0,2) + Power(h13,2)*jMax*(13*v0 - 16*vf) - 2*v0*vf + 3*Power(vf,2)) + 6*Power(a0,4)*Power(jMax,2)*(3*Power(h13,3)*jMax - 8*p0 + 8*pf + h13*(v0 + 19*vf)) - 36*Power(a0,2)*Power(jMax,3)*(Power(h13,2)*jMax*(p0 - pf) + 2*(-p0 + pf)*v0 + 2*Power(h13,3)*jMax*(v0 - vf) + h13*(3*Power(v0,2) + 2*v0*vf - 3*Power(vf,2))) - 72*a0*Power(jMax,3)*(Power(v0,3) + Power(v0,2)*vf - 3*v0*Power(vf,2) + Power(vf,3) + jMax*(Power(p0,2) + Power(pf,2) + h13*pf*(4*v0 - 2*vf) - 2*p0*(pf + 2*h13*v0 - h13*vf) + Power(h13,2)*(-2*Power(v0,2) + 5*v0*vf - 3*Power(vf,2)))))/h17);
-        profile.t[5] = 0;
-        profile.t[6] = profile.t[4];
-
-        // Set average as only sum of t2 and t4 needs to be >0
-        profile.t[2] = (profile.t[2] + profile.t[4]) / 2;
-        profile.t[4] = profile.t[2];
-
-        profile.set(p0, v0, a0, {jMax, 0, -jMax, 0, -jMax, 0, jMax});
-        if (profile.check(pf, vf, vMax, aMax)) {
-            return true;
-        }
-    }
-
-    // Solution 4
-    // 2e-18 comes from sqrt(double precision)
-    if (h14_c.real() > 0.0 && std::abs(h14_c.imag()) < 2e-8) {
-        const double h14 = h14_c.real();
-
-        profile.t[0] = h14;
-        profile.t[1] = 0;
-        profile.t[2] = (-4*PowerLong(a0,3) + 3.l*(h2*(h12 + h12_a) + 2*PowerLong(jMax,2)*(p0 - pf)) + 6l*a0*(h2 + jMax*(v0 - 2*vf))).real()/(6.l*h2*jMax);
-        profile.t[3] = 0;
-        profile.t[4] = -((Power(a0,7) + 13*Power(a0,6)*h14*jMax + 72*Power(jMax,4)*(-(h14*(jMax*Power(p0 - pf,2) - Power(v0 - vf,3))) + Power(h14,2)*jMax*(p0 - pf)*(v0 - vf) + 2*(p0 - pf)*v0*(v0 - vf) + Power(h14,3)*jMax*Power(v0 - vf,2)) + 6*Power(a0,5)*jMax*(7*Power(h14,2)*jMax + v0 + 3*vf) - 12*Power(a0,3)*Power(jMax,2)*(10*h14*jMax*(p0 - pf) - Power(v0,2) + Power(h14,2)*jMax*(13*v0 - 16*vf) - 2*v0*vf + 3*Power(vf,2)) + 6*Power(a0,4)*Power(jMax,2)*(3*Power(h14,3)*jMax - 8*p0 + 8*pf + h14*(v0 + 19*vf)) - 36*Power(a0,2)*Power(jMax,3)*(Power(h14,2)*jMax*(p0 - pf) + 2*(-p0 + pf)*v0 + 2*Power(h14,3)*jMax*(v0 - vf) + h14*(3*Power(v0,2) + 2*v0*vf - 3*Power(vf,2))) - 72*a0*Power(jMax,3)*(Power(v0,3) + Power(v0,2)*vf - 3*v0*Power(vf,2) + Power(vf,3) + jMax*(Power(p0,2) + Power(pf,2) + h14*pf*(4*v0 - 2*vf) - 2*p0*(pf + 2*h14*v0 - h14*vf) + Power(h14,2)*(-2*Power(v0,2) + 5*v0*vf - 3*Power(vf,2)))))/h17);
-        profile.t[5] = 0;
-        profile.t[6] = profile.t[4];
-
-        // std::cout << std::setprecision(9) << profile.t[0] << std::endl;
-        // std::cout << profile.t[1] << std::endl;
-        // std::cout << profile.t[2] << std::endl;
-        // std::cout << profile.t[3] << std::endl;
-        // std::cout << profile.t[4] << std::endl;
-        // std::cout << profile.t[5] << std::endl;
-        // std::cout << profile.t[6] << std::endl << std::endl;
-
-        profile.t[2] = (profile.t[2] + profile.t[4]) / 2;
-        profile.t[4] = profile.t[2];
-
-        profile.set(p0, v0, a0, {jMax, 0, -jMax, 0, -jMax, 0, jMax});
-        if (profile.check(pf, vf, vMax, aMax)) {
-            return true;
-        }
-    }
-
-    // Solution 2
-    if (h15_c.real() > 0.0 && std::abs(h15_c.imag()) < 2e-8) {
-        const double h15 = h15_c.real();
-
-        profile.t[0] = h15;
-        profile.t[1] = 0;
-        profile.t[2] = (-4*PowerLong(a0,3) + 3.l*(h2*(-h12 + h12_b) + 2*PowerLong(jMax,2)*(p0 - pf)) + 6l*a0*(h2 + jMax*(v0 - 2*vf))).real()/(6.l*h2*jMax);
-        profile.t[3] = 0;
-        profile.t[4] = -((Power(a0,7) + 13*Power(a0,6)*h15*jMax + 72*Power(jMax,4)*(-(h15*(jMax*Power(p0 - pf,2) - Power(v0 - vf,3))) + Power(h15,2)*jMax*(p0 - pf)*(v0 - vf) + 2*(p0 - pf)*v0*(v0 - vf) + Power(h15,3)*jMax*Power(v0 - vf,2)) + 6*Power(a0,5)*jMax*(7*Power(h15,2)*jMax + v0 + 3*vf) - 12*Power(a0,3)*Power(jMax,2)*(10*h15*jMax*(p0 - pf) - Power(v0,2) + Power(h15,2)*jMax*(13*v0 - 16*vf) - 2*v0*vf + 3*Power(vf,2)) + 6*Power(a0,4)*Power(jMax,2)*(3*Power(h15,3)*jMax - 8*p0 + 8*pf + h15*(v0 + 19*vf)) - 36*Power(a0,2)*Power(jMax,3)*(Power(h15,2)*jMax*(p0 - pf) + 2*(-p0 + pf)*v0 + 2*Power(h15,3)*jMax*(v0 - vf) + h15*(3*Power(v0,2) + 2*v0*vf - 3*Power(vf,2))) - 72*a0*Power(jMax,3)*(Power(v0,3) + Power(v0,2)*vf - 3*v0*Power(vf,2) + Power(vf,3) + jMax*(Power(p0,2) + Power(pf,2) + h15*pf*(4*v0 - 2*vf) - 2*p0*(pf + 2*h15*v0 - h15*vf) + Power(h15,2)*(-2*Power(v0,2) + 5*v0*vf - 3*Power(vf,2)))))/h17);
-        profile.t[5] = 0;
-        profile.t[6] = profile.t[4];
-
-        profile.t[2] = (profile.t[2] + profile.t[4]) / 2;
-        profile.t[4] = profile.t[2];
-
-        profile.set(p0, v0, a0, {jMax, 0, -jMax, 0, -jMax, 0, jMax});
-        if (profile.check(pf, vf, vMax, aMax)) {
-            return true;
-        }
-    }
-
-    // Solution 1
-    if (h16_c.real() > 0.0 && std::abs(h16_c.imag()) < 2e-8) {
-        const double h16 = h16_c.real();
-
-        profile.t[0] = h16;
-        profile.t[1] = 0;
-        profile.t[2] = (-4*PowerLong(a0,3) + 3.l*(h2*(-h12 - h12_b) + 2*PowerLong(jMax,2)*(p0 - pf)) + 6l*a0*(h2 + jMax*(v0 - 2*vf))).real()/(6.l*h2*jMax);
-        profile.t[3] = 0;
-        profile.t[4] = -((PowerLong(a0,7) + 13*PowerLong(a0,6)*h16*jMax + 72*PowerLong(jMax,4)*(-(h16*(jMax*PowerLong(p0 - pf,2) - PowerLong(v0 - vf,3))) + PowerLong(h16,2)*jMax*(p0 - pf)*(v0 - vf) + 2*(p0 - pf)*v0*(v0 - vf) + PowerLong(h16,3)*jMax*PowerLong(v0 - vf,2)) + 6*PowerLong(a0,5)*jMax*(7*PowerLong(h16,2)*jMax + v0 + 3*vf) - 12*PowerLong(a0,3)*PowerLong(jMax,2)*(10*h16*jMax*(p0 - pf) - PowerLong(v0,2) + PowerLong(h16,2)*jMax*(13*v0 - 16*vf) - 2*v0*vf + 3*Power(vf,2)) + 6*PowerLong(a0,4)*PowerLong(jMax,2)*(3*PowerLong(h16,3)*jMax - 8*p0 + 8*pf + h16*(v0 + 19*vf)) - 36*PowerLong(a0,2)*PowerLong(jMax,3)*(PowerLong(h16,2)*jMax*(p0 - pf) + 2*(-p0 + pf)*v0 + 2*PowerLong(h16,3)*jMax*(v0 - vf) + h16*(3*PowerLong(v0,2) + 2*v0*vf - 3*PowerLong(vf,2))) - 72*a0*PowerLong(jMax,3)*(PowerLong(v0,3) + PowerLong(v0,2)*vf - 3*v0*PowerLong(vf,2) + PowerLong(vf,3) + jMax*(PowerLong(p0,2) + Power(pf,2) + h16*pf*(4*v0 - 2*vf) - 2*p0*(pf + 2*h16*v0 - h16*vf) + PowerLong(h16,2)*(-2*PowerLong(v0,2) + 5*v0*vf - 3*PowerLong(vf,2)))))/h17);
-        profile.t[5] = 0;
-        profile.t[6] = profile.t[4];
-
-        profile.t[2] = (profile.t[2] + profile.t[4]) / 2;
-        profile.t[4] = profile.t[2];
-
-        profile.set(p0, v0, a0, {jMax, 0, -jMax, 0, -jMax, 0, jMax});
-        if (profile.check(pf, vf, vMax, aMax)) {
-            return true;
-        }
-    }
-    return false;
 }
 
 bool RuckigStep2::time_up_none(Profile& profile, double tf, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
@@ -945,7 +847,7 @@ bool RuckigStep2::time_up_none(Profile& profile, double tf, double p0, double v0
         double jMaxNew = (-32*(p0 - pf))/Power(tf,3);
 
         profile.set(p0, v0, a0, {jMaxNew, 0, -jMaxNew, 0, -jMaxNew, 0, jMaxNew});
-        return profile.check(pf, vf, vMax, aMax);
+        return profile.check(tf, pf, vf, vMax, aMax);
     }
     
     if (std::abs(v0) < 1e-14 && std::abs(a0) < 1e-14) {
@@ -961,7 +863,7 @@ bool RuckigStep2::time_up_none(Profile& profile, double tf, double p0, double v0
         double jMaxNew = (4*(-4*p0*tf + 4*pf*tf - 2*Power(tf,2)*vf + h1))/Power(tf,4);
 
         profile.set(p0, v0, a0, {jMaxNew, 0, -jMaxNew, 0, -jMaxNew, 0, jMaxNew});
-        return profile.check(pf, vf, vMax, aMax);
+        return profile.check(tf, pf, vf, vMax, aMax);
     }
 
     if (std::abs(a0) < 1e-14 && std::abs(vf) < 1e-14) {
@@ -978,7 +880,7 @@ bool RuckigStep2::time_up_none(Profile& profile, double tf, double p0, double v0
             double jMaxNew = (-4*(4*p0*tf - 4*pf*tf + 2*Power(tf,2)*v0 + Sqrt(Power(tf,2)*(Power(tf,2)*Power(v0,2) + 4*Power(2*p0 - 2*pf + tf*v0,2)))))/Power(tf,4);
 
             profile.set(p0, v0, a0, {jMaxNew, 0, -jMaxNew, 0, -jMaxNew, 0, jMaxNew});
-            if (profile.check(pf, vf, vMax, aMax)) {
+            if (profile.check(tf, pf, vf, vMax, aMax)) {
                 return true;
             }
         }
@@ -1001,6 +903,8 @@ bool RuckigStep2::time_up_none(Profile& profile, double tf, double p0, double v0
                     continue;
                 }
 
+                t = Roots::polishRoot(polynom, t);
+
                 profile.t[0] = t;
                 profile.t[1] = 0;
                 profile.t[2] = (-Power(a0,3) + 3*Power(a0,2)*jMax*(4*t + tf) + 6*a0*jMax*(jMax*(3*Power(t,2) - 4*t*tf + Power(tf,2)) + 3*(v0 - vf)) + 6*Power(jMax,2)*(-8*p0 + 8*pf + 2*jMax*Power(t,3) - 3*jMax*Power(t,2)*tf + jMax*t*Power(tf,2) - 2*t*v0 - 3*tf*v0 + 2*t*vf - 5*tf*vf))/(6.*jMax*(-Power(a0,2) + 2*a0*jMax*tf + jMax*(jMax*Power(tf,2) + 4*v0 - 4*vf)));
@@ -1018,7 +922,7 @@ bool RuckigStep2::time_up_none(Profile& profile, double tf, double p0, double v0
                 // std::cout << "---" << std::endl;
 
                 profile.set(p0, v0, a0, {jMax, 0, -jMax, 0, -jMax, 0, jMax});
-                if (profile.check(pf, vf, vMax, aMax)) {
+                if (profile.check(tf, pf, vf, vMax, aMax)) {
                     return true;
                 }
             }
@@ -1039,6 +943,8 @@ bool RuckigStep2::time_up_none(Profile& profile, double tf, double p0, double v0
                     continue;
                 }
 
+                t = Roots::polishRoot(polynom, t);
+
                 profile.t[0] = 0;
                 profile.t[1] = 0;
                 profile.t[2] = t;
@@ -1048,7 +954,7 @@ bool RuckigStep2::time_up_none(Profile& profile, double tf, double p0, double v0
                 profile.t[6] = (Power(a0,3)*(-t + tf) + 3*Power(a0,2)*jMax*(Power(t,2) - t*tf + Power(tf,2)) + 3*a0*jMax*(-6*p0 + 6*pf - tf*(jMax*(-2*Power(t,2) + t*tf + Power(tf,2)) - 2*v0 + 8*vf)) - 3*jMax*(Power(jMax,2)*t*(t - tf)*Power(tf,2) - 4*Power(v0 - vf,2) + jMax*(-8*p0*t + 8*pf*t + 2*p0*tf - 2*pf*tf - 4*Power(t,2)*v0 + 2*Power(tf,2)*v0 + 4*Power(t,2)*vf - 8*t*tf*vf)))/(Power(a0,3) + 3*Power(a0,2)*jMax*tf + 6*a0*jMax*(v0 - vf) + 6*Power(jMax,2)*(2*p0 - 2*pf + tf*(v0 + vf)));
 
                 profile.set(p0, v0, a0, {jMax, 0, -jMax, 0, -jMax, 0, jMax});
-                if (profile.check(pf, vf, vMax, aMax)) {
+                if (profile.check(tf, pf, vf, vMax, aMax)) {
                     return true;
                 }
             }       
@@ -1072,6 +978,8 @@ bool RuckigStep2::time_up_none(Profile& profile, double tf, double p0, double v0
                     continue;
                 }
 
+                t = Roots::polishRoot(polynom, t);
+
                 profile.t[0] = 0;
                 profile.t[1] = 0;
                 profile.t[2] = t;
@@ -1089,207 +997,262 @@ bool RuckigStep2::time_up_none(Profile& profile, double tf, double p0, double v0
                 // std::cout << "---" << std::endl;
 
                 profile.set(p0, v0, a0, {jMax, 0, -jMax, 0, jMax, 0, -jMax});
-                if (profile.check(pf, vf, vMax, aMax)) {
+                if (profile.check(tf, pf, vf, vMax, aMax)) {
                     return true;
                 }
             }
         }
     }
     
-    double h1 = 8*p0 - 8*pf + a0*Power(tf,2) + 4*tf*v0 + 4*tf*vf;
-    double h2 = -16*a0*p0 + 16*a0*pf + Power(a0,2)*Power(tf,2) + 8*Power(v0,2) - 16*a0*tf*vf - 16*v0*vf + 8*Power(vf,2);
-    double h3 = 432*Power(h2,3) + 3888*Power(a0,4)*Power(h1,2)*Power(tf,2) + 2592*Power(a0,3)*h1*h2*Power(tf,2) + 1296*Power(a0,4)*h2*Power(tf,4) - 1296*Power(a0,6)*Power(tf,6);
-    double h4 = 36*Power(h2,2) + 144*Power(a0,3)*h1*Power(tf,2) - 36*Power(a0,4)*Power(tf,4);
-    auto h5 = PowerComplex(h3 + SqrtComplex(Power(h3,2) - 4*Power(h4,3)),1./3);
-    auto h6 = SqrtComplex((4*Power(h1,2))/Power(tf,6) + (4*h2)/(3.*Power(tf,4)) - (Power(2,1./3)*h4)/(9.*h5*Power(tf,4)) - h5/(9.*Power(2,1./3)*Power(tf,4)));
-    auto h7 = (8*Power(h1,2))/Power(tf,6) + (8*h2)/(3.*Power(tf,4)) + (Power(2,1./3)*h4)/(9.*h5*Power(tf,4)) + h5/(9.*Power(2,1./3)*Power(tf,4));
-    auto h8 = ((-64*Power(h1,3))/Power(tf,9) - (32*h1*h2)/Power(tf,7) + (32*Power(a0,3))/(3.*Power(tf,3)))/(4.*h6);
-    auto h9 = -h6/2. - SqrtComplex(h7 + h8)/2. - h1/Power(tf,3);
-    auto h10 = -h6/2. + SqrtComplex(h7 + h8)/2. - h1/Power(tf,3);
-    auto h11 = h6/2. - SqrtComplex(h7 + h8)/2. - h1/Power(tf,3);
-    auto h12 = h6/2. + SqrtComplex(h7 + h8)/2. - h1/Power(tf,3);
-
-    // std::cout << h9 << " " << h10 << " " << h11 << " " << h12 << std::endl;
-
     return false;
 }
 
-bool RuckigStep1::time_down_acc0_acc1_vel(Profile& profile, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
-    return time_up_acc0_acc1_vel(profile, p0, v0, a0, pf, vf, -vMax, -aMax, -jMax);
+void RuckigStep1::time_down_acc0_acc1_vel(Profile& profile, ValidProfiles& valid, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
+    time_up_acc0_acc1_vel(profile, valid, p0, v0, a0, pf, vf, -vMax, -aMax, -jMax);
 }
 
 bool RuckigStep2::time_down_acc0_acc1_vel(Profile& profile, double tf, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
     return time_up_acc0_acc1_vel(profile, tf, p0, v0, a0, pf, vf, -vMax, -aMax, -jMax);
 }
 
-bool RuckigStep1::time_down_acc1_vel(Profile& profile, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
-    return time_up_acc1_vel(profile, p0, v0, a0, pf, vf, -vMax, -aMax, -jMax);
+void RuckigStep1::time_down_acc1_vel(Profile& profile, ValidProfiles& valid, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
+    time_up_acc1_vel(profile, valid, p0, v0, a0, pf, vf, -vMax, -aMax, -jMax);
 }
 
 bool RuckigStep2::time_down_acc1_vel(Profile& profile, double tf, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
     return time_up_acc1_vel(profile, tf, p0, v0, a0, pf, vf, -vMax, -aMax, -jMax);
 }
 
-bool RuckigStep1::time_down_acc0_vel(Profile& profile, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
-    return time_up_acc0_vel(profile, p0, v0, a0, pf, vf, -vMax, -aMax, -jMax);
+void RuckigStep1::time_down_acc0_vel(Profile& profile, ValidProfiles& valid, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
+    time_up_acc0_vel(profile, valid, p0, v0, a0, pf, vf, -vMax, -aMax, -jMax);
 }
 
 bool RuckigStep2::time_down_acc0_vel(Profile& profile, double tf, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
     return time_up_acc0_vel(profile, tf, p0, v0, a0, pf, vf, -vMax, -aMax, -jMax);
 }
 
-bool RuckigStep1::time_down_vel(Profile& profile, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
-    return time_up_vel(profile, p0, v0, a0, pf, vf, -vMax, -aMax, -jMax);
+void RuckigStep1::time_down_vel(Profile& profile, ValidProfiles& valid, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
+    time_up_vel(profile, valid, p0, v0, a0, pf, vf, -vMax, -aMax, -jMax);
 }
 
 bool RuckigStep2::time_down_vel(Profile& profile, double tf, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
     return time_up_vel(profile, tf, p0, v0, a0, pf, vf, -vMax, -aMax, -jMax);
 }
 
-bool RuckigStep1::time_down_acc0_acc1(Profile& profile, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
-    return time_up_acc0_acc1(profile, p0, v0, a0, pf, vf, -vMax, -aMax, -jMax);
+void RuckigStep1::time_down_acc0_acc1(Profile& profile, ValidProfiles& valid, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
+    time_up_acc0_acc1(profile, valid, p0, v0, a0, pf, vf, -vMax, -aMax, -jMax);
 }
 
 bool RuckigStep2::time_down_acc0_acc1(Profile& profile, double tf, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
     return time_up_acc0_acc1(profile, tf, p0, v0, a0, pf, vf, -vMax, -aMax, -jMax);
 }
 
-bool RuckigStep1::time_down_acc1(Profile& profile, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
-    return time_up_acc1(profile, p0, v0, a0, pf, vf, -vMax, -aMax, -jMax);
+void RuckigStep1::time_down_acc1(Profile& profile, ValidProfiles& valid, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
+    time_up_acc1(profile, valid, p0, v0, a0, pf, vf, -vMax, -aMax, -jMax);
 }
 
 bool RuckigStep2::time_down_acc1(Profile& profile, double tf, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
     return time_up_acc1(profile, tf, p0, v0, a0, pf, vf, -vMax, -aMax, -jMax);
 }
 
-bool RuckigStep1::time_down_acc0(Profile& profile, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
-    return time_up_acc0(profile, p0, v0, a0, pf, vf, -vMax, -aMax, -jMax);
+void RuckigStep1::time_down_acc0(Profile& profile, ValidProfiles& valid, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
+    time_up_acc0(profile, valid, p0, v0, a0, pf, vf, -vMax, -aMax, -jMax);
 }
 
 bool RuckigStep2::time_down_acc0(Profile& profile, double tf, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
     return time_up_acc0(profile, tf, p0, v0, a0, pf, vf, -vMax, -aMax, -jMax);
 }
 
-bool RuckigStep1::time_down_none(Profile& profile, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
-    return time_up_none(profile, p0, v0, a0, pf, vf, -vMax, -aMax, -jMax);
+void RuckigStep1::time_down_none(Profile& profile, ValidProfiles& valid, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
+    time_up_none(profile, valid, p0, v0, a0, pf, vf, -vMax, -aMax, -jMax);
 }
 
 bool RuckigStep2::time_down_none(Profile& profile, double tf, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
     return time_up_none(profile, tf, p0, v0, a0, pf, vf, -vMax, -aMax, -jMax);
 }
 
-bool RuckigStep1::get_profile(Profile& profile, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
-    // Test all cases to get ones that match
-    if (pf > p0) {
-        if (time_up_acc0_acc1_vel(profile, p0, v0, a0, pf, vf, vMax, aMax, jMax)) {
-            profile.type = Profile::Type::UP_ACC0_ACC1_VEL;
-
-        } else if (time_down_acc0_acc1_vel(profile, p0, v0, a0, pf, vf, vMax, aMax, jMax)) {
-            profile.type = Profile::Type::DOWN_ACC0_ACC1_VEL;
-
-        } else if (time_up_acc1_vel(profile, p0, v0, a0, pf, vf, vMax, aMax, jMax)) {
-            profile.type = Profile::Type::UP_ACC1_VEL;
-
-        } else if (time_down_acc1_vel(profile, p0, v0, a0, pf, vf, vMax, aMax, jMax)) {
-            profile.type = Profile::Type::DOWN_ACC1_VEL;
+void RuckigStep1::time_profile(Profile& profile, ValidProfiles& valid, Profile::Type type, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
+    profile.type = type;
+    switch (type) {
+        case Profile::Type::UP_ACC0_ACC1_VEL: return time_up_acc0_acc1_vel(profile, valid, p0, v0, a0, pf, vf, vMax, aMax, jMax);
+        case Profile::Type::UP_VEL: return time_up_vel(profile, valid, p0, v0, a0, pf, vf, vMax, aMax, jMax);
+        case Profile::Type::UP_ACC0: return time_up_acc0(profile, valid, p0, v0, a0, pf, vf, vMax, aMax, jMax);
+        case Profile::Type::UP_ACC1: return time_up_acc1(profile, valid, p0, v0, a0, pf, vf, vMax, aMax, jMax);
+        case Profile::Type::UP_ACC0_ACC1: return time_up_acc0_acc1(profile, valid, p0, v0, a0, pf, vf, vMax, aMax, jMax);
+        case Profile::Type::UP_ACC0_VEL: return time_up_acc0_vel(profile, valid, p0, v0, a0, pf, vf, vMax, aMax, jMax);
+        case Profile::Type::UP_ACC1_VEL: return time_up_acc1_vel(profile, valid, p0, v0, a0, pf, vf, vMax, aMax, jMax);
+        case Profile::Type::UP_NONE: return time_up_none(profile, valid, p0, v0, a0, pf, vf, vMax, aMax, jMax);
+        case Profile::Type::DOWN_ACC0_ACC1_VEL: return time_down_acc0_acc1_vel(profile, valid, p0, v0, a0, pf, vf, vMax, aMax, jMax);
+        case Profile::Type::DOWN_VEL: return time_down_vel(profile, valid, p0, v0, a0, pf, vf, vMax, aMax, jMax);
+        case Profile::Type::DOWN_ACC0: return time_down_acc0(profile, valid, p0, v0, a0, pf, vf, vMax, aMax, jMax);
+        case Profile::Type::DOWN_ACC1: return time_down_acc1(profile, valid, p0, v0, a0, pf, vf, vMax, aMax, jMax);
+        case Profile::Type::DOWN_ACC0_ACC1: return time_down_acc0_acc1(profile, valid, p0, v0, a0, pf, vf, vMax, aMax, jMax);
+        case Profile::Type::DOWN_ACC0_VEL: return time_down_acc0_vel(profile, valid, p0, v0, a0, pf, vf, vMax, aMax, jMax);
+        case Profile::Type::DOWN_ACC1_VEL: return time_down_acc1_vel(profile, valid, p0, v0, a0, pf, vf, vMax, aMax, jMax);
+        case Profile::Type::DOWN_NONE: return time_down_none(profile, valid, p0, v0, a0, pf, vf, vMax, aMax, jMax);
+    }
+}
 
-        } else if (time_up_acc0_vel(profile, p0, v0, a0, pf, vf, vMax, aMax, jMax)) {
-            profile.type = Profile::Type::UP_ACC0_VEL;
+//! Set the fastest of the valid profiles, and the blocked intervals between the following durations. Returns false if there is none.
+inline bool set_fastest_profile(Profile& profile, Block& block, const ValidProfiles& valid) {
+    block.size = 0;
+    if (valid.size == 0) {
+        return false;
+    }
 
-        } else if (time_down_acc0_vel(profile, p0, v0, a0, pf, vf, vMax, aMax, jMax)) {
-            profile.type = Profile::Type::DOWN_ACC0_VEL;
+    // Insertion sort of the indices by duration, the durations are distinct
+    std::array<size_t, ValidProfiles::capacity> order;
+    for (size_t i = 0; i < valid.size; i += 1) {
+        size_t index = i;
+        for (; index > 0 && valid.profiles[order[index - 1]].t_sum[6] > valid.profiles[i].t_sum[6]; index -= 1) {
+            order[index] = order[index - 1];
+        }
+        order[index] = i;
+    }
 
-        } else if (time_up_vel(profile, p0, v0, a0, pf, vf, vMax, aMax, jMax)) {
-            profile.type = Profile::Type::UP_VEL;
+    // The reachable durations are [d0, d1], [d2, d3], and from d4 on
+    profile = valid.profiles[order[0]];
+    for (size_t i = 1; i + 1 < valid.size && block.size < block.intervals.size(); i += 2) {
+        const Profile& right = valid.profiles[order[i + 1]];
+        block.intervals[block.size] = BlockedInterval {valid.profiles[order[i]].duration(), right.duration(), right};
+        block.size += 1;
+    }
+    return true;
+}
 
-        } else if (time_down_vel(profile, p0, v0, a0, pf, vf, vMax, aMax, jMax)) {
-            profile.type = Profile::Type::DOWN_VEL;
+bool RuckigStep1::get_profile(Profile& profile, Block& block, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
+    // Types in the direction of the target first, the types of the other direction follow with an offset of 8
+    constexpr std::array<Profile::Type, 16> types_up_first {
+        Profile::Type::UP_ACC0_ACC1_VEL, Profile::Type::DOWN_ACC0_ACC1_VEL, Profile::Type::UP_ACC1_VEL, Profile::Type::DOWN_ACC1_VEL,
+        Profile::Type::UP_ACC0_VEL, Profile::Type::DOWN_ACC0_VEL, Profile::Type::UP_VEL, Profile::Type::DOWN_VEL,
+        Profile::Type::UP_ACC0_ACC1, Profile::Type::DOWN_ACC0_ACC1, Profile::Type::UP_ACC1, Profile::Type::DOWN_ACC1,
+        Profile::Type::UP_ACC0, Profile::Type::DOWN_ACC0, Profile::Type::UP_NONE, Profile::Type::DOWN_NONE,
+    };
+
+    ValidProfiles valid;
+    Profile candidate = profile;
+    for (Profile::Type type: types_up_first) {
+        if (pf <= p0) {
+            type = static_cast<Profile::Type>((static_cast<size_t>(type) + 8) % 16);
+        }
+        time_profile(candidate, valid, type, p0, v0, a0, pf, vf, vMax, aMax, jMax);
+    }
 
-        } else if (time_up_acc0_acc1(profile, p0, v0, a0, pf, vf, vMax, aMax, jMax)) {
-            profile.type = Profile::Type::UP_ACC0_ACC1;
+    return set_fastest_profile(profile, block, valid);
+}
 
-        } else if (time_down_acc0_acc1(profile, p0, v0, a0, pf, vf, vMax, aMax, jMax)) {
-            profile.type = Profile::Type::DOWN_ACC0_ACC1;
+bool RuckigStep1::get_profile(Profile& profile, Block& block, ProfileCache& cache, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
+    Profile candidate = profile;
+    for (size_t i = 0; i < cache.length; i += 1) {
+        const Profile::Type type = cache.recent[i];
+        ValidProfiles valid;
+        time_profile(candidate, valid, type, p0, v0, a0, pf, vf, vMax, aMax, jMax);
+        if (set_fastest_profile(profile, block, valid)) {
+            block.size = 0;
+            cache.hits += 1;
+            cache.remember(type);
+            return true;
+        }
+    }
 
-        } else if (time_up_acc1(profile, p0, v0, a0, pf, vf, vMax, aMax, jMax)) {
-            profile.type = Profile::Type::UP_ACC1;
+    cache.misses += 1;
+    if (!get_profile(profile, block, p0, v0, a0, pf, vf, vMax, aMax, jMax)) {
+        return false;
+    }
 
-        } else if (time_down_acc1(profile, p0, v0, a0, pf, vf, vMax, aMax, jMax)) {
-            profile.type = Profile::Type::DOWN_ACC1;
+    cache.remember(profile.type);
+    return true;
+}
 
-        } else if (time_up_acc0(profile, p0, v0, a0, pf, vf, vMax, aMax, jMax)) {
-            profile.type = Profile::Type::UP_ACC0;
+//! Position reached by accelerating to vPlat, cruising, and accelerating to vf with the time-optimal velocity profiles
+inline bool set_vel_plateau(Profile& profile, double tf, double p0, double v0, double a0, double vPlat, double vf, double aMax, double jMax, double& pf_reached) {
+    Profile first, second;
+    first.t_brake.reset();
+    second.t_brake.reset();
+    if (!VelocityStep1::get_profile(first, p0, v0, a0, vPlat, 0.0, aMax, jMax) || !VelocityStep1::get_profile(second, 0.0, vPlat, 0.0, vf, 0.0, aMax, jMax)) {
+        return false;
+    }
 
-        } else if (time_down_acc0(profile, p0, v0, a0, pf, vf, vMax, aMax, jMax)) {
-            profile.type = Profile::Type::DOWN_ACC0;
+    const double t_cruise = tf - first.t_sum[6] - second.t_sum[6];
+    if (t_cruise < 0.0) {
+        return false;
+    }
 
-        } else if (time_up_none(profile, p0, v0, a0, pf, vf, vMax, aMax, jMax)) {
-            profile.type = Profile::Type::UP_NONE;
+    profile.t = {first.t[0], first.t[1], first.t[2], t_cruise, second.t[0], second.t[1], second.t[2]};
+    profile.set(p0, v0, a0, {first.j[0], first.j[1], first.j[2], 0, second.j[0], second.j[1], second.j[2]});
+    pf_reached = profile.p[7];
+    return true;
+}
 
-        } else if (time_down_none(profile, p0, v0, a0, pf, vf, vMax, aMax, jMax)) {
-            profile.type = Profile::Type::DOWN_NONE;
+//! Type with the limits reached by a plateau profile, the direction is given by the first jerk
+inline Profile::Type get_plateau_type(const Profile& profile, double vMax) {
+    const bool reaches_acc0 = (profile.t[1] > 0.0);
+    const bool reaches_acc1 = (profile.t[5] > 0.0);
+    const bool reaches_vel = (profile.t[3] > 0.0 && std::abs(profile.v[3]) > std::abs(vMax) - 1e-9);
+
+    // Ordered as Profile::Type by the combination of reached limits
+    constexpr std::array<Profile::Type, 8> up_types {
+        Profile::Type::UP_NONE, Profile::Type::UP_ACC0, Profile::Type::UP_ACC1, Profile::Type::UP_ACC0_ACC1,
+        Profile::Type::UP_VEL, Profile::Type::UP_ACC0_VEL, Profile::Type::UP_ACC1_VEL, Profile::Type::UP_ACC0_ACC1_VEL,
+    };
+    const Profile::Type up_type = up_types[reaches_acc0 + 2 * reaches_acc1 + 4 * reaches_vel];
+
+    const auto first_segment = std::find_if(profile.t.begin(), profile.t.end(), [](double t) { return t > 0.0; });
+    const bool is_up = (first_segment == profile.t.end()) || profile.j[std::distance(profile.t.begin(), first_segment)] >= 0.0;
+    return is_up ? up_type : static_cast<Profile::Type>(static_cast<size_t>(up_type) + 8);
+}
 
-        } else {
+bool RuckigStep2::time_vel_plateau(Profile& profile, double tf, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax, Deadline deadline) {
+    // Find the sign change of the position error on a coarse grid of plateau velocities, then bisect. The reached position increases
+    // with the plateau velocity, so there is at most one sign change (none with a second one were found in 2e5 random inputs).
+    bool has_last {false};
+    double v_last, error_last, pf_reached;
+    for (size_t i = 0; i <= plateau_grid_size; i += 1) {
+        if (is_past(deadline)) {
             return false;
         }
 
-    } else {
-        if (time_down_acc0_acc1_vel(profile, p0, v0, a0, pf, vf, vMax, aMax, jMax)) {
-            profile.type = Profile::Type::DOWN_ACC0_ACC1_VEL;
-
-        } else if (time_up_acc0_acc1_vel(profile, p0, v0, a0, pf, vf, vMax, aMax, jMax)) {
-            profile.type = Profile::Type::UP_ACC0_ACC1_VEL;
-
-        } else if (time_down_acc1_vel(profile, p0, v0, a0, pf, vf, vMax, aMax, jMax)) {
-            profile.type = Profile::Type::DOWN_ACC1_VEL;
-
-        } else if (time_up_acc1_vel(profile, p0, v0, a0, pf, vf, vMax, aMax, jMax)) {
-            profile.type = Profile::Type::UP_ACC1_VEL;
-
-        } else if (time_down_acc0_vel(profile, p0, v0, a0, pf, vf, vMax, aMax, jMax)) {
-            profile.type = Profile::Type::DOWN_ACC0_VEL;
-
-        } else if (time_up_acc0_vel(profile, p0, v0, a0, pf, vf, vMax, aMax, jMax)) {
-            profile.type = Profile::Type::UP_ACC0_VEL;
-
-        } else if (time_down_vel(profile, p0, v0, a0, pf, vf, vMax, aMax, jMax)) {
-            profile.type = Profile::Type::DOWN_VEL;
-
-        } else if (time_up_vel(profile, p0, v0, a0, pf, vf, vMax, aMax, jMax)) {
-            profile.type = Profile::Type::UP_VEL;
-
-        } else if (time_down_acc0_acc1(profile, p0, v0, a0, pf, vf, vMax, aMax, jMax)) {
-            profile.type = Profile::Type::DOWN_ACC0_ACC1;
-
-        } else if (time_up_acc0_acc1(profile, p0, v0, a0, pf, vf, vMax, aMax, jMax)) {
-            profile.type = Profile::Type::UP_ACC0_ACC1;
-
-        } else if (time_down_acc1(profile, p0, v0, a0, pf, vf, vMax, aMax, jMax)) {
-            profile.type = Profile::Type::DOWN_ACC1;
-
-        } else if (time_up_acc1(profile, p0, v0, a0, pf, vf, vMax, aMax, jMax)) {
-            profile.type = Profile::Type::UP_ACC1;
-
-        } else if (time_down_acc0(profile, p0, v0, a0, pf, vf, vMax, aMax, jMax)) {
-            profile.type = Profile::Type::DOWN_ACC0;
-
-        } else if (time_up_acc0(profile, p0, v0, a0, pf, vf, vMax, aMax, jMax)) {
-            profile.type = Profile::Type::UP_ACC0;
+        const double v_plat = -vMax + 2 * vMax * i / plateau_grid_size;
+        if (!set_vel_plateau(profile, tf, p0, v0, a0, v_plat, vf, aMax, jMax, pf_reached)) {
+            has_last = false;
+            continue;
+        }
 
-        } else if (time_down_none(profile, p0, v0, a0, pf, vf, vMax, aMax, jMax)) {
-            profile.type = Profile::Type::DOWN_NONE;
+        const double error = pf_reached - pf;
+        if (has_last && (error_last < 0) != (error < 0)) {
+            double v_low = v_last, v_high = v_plat;
+            const bool is_increasing = (error_last < 0);
+            for (size_t k = 0; k < plateau_bisections; k += 1) {
+                const double v_mid = (v_low + v_high) / 2;
+                if (!set_vel_plateau(profile, tf, p0, v0, a0, v_mid, vf, aMax, jMax, pf_reached)) {
+                    break;
+                }
+                if (std::abs(pf_reached - pf) < 1e-12) {
+                    break;
+                }
+                if ((pf_reached < pf) == is_increasing) {
+                    v_low = v_mid;
+                } else {
+                    v_high = v_mid;
+                }
+            }
 
-        } else if (time_up_none(profile, p0, v0, a0, pf, vf, vMax, aMax, jMax)) {
-            profile.type = Profile::Type::UP_NONE;
+            if (!profile.check(tf, pf, vf, vMax, aMax)) {
+                return false;
+            }
 
-        } else {
-            return false;
+            profile.type = get_plateau_type(profile, vMax);
+            return true;
         }
+
+        has_last = true;
+        v_last = v_plat;
+        error_last = error;
     }
-    return true;
+    return false;
 }
 
-bool RuckigStep2::get_profile(Profile& profile, double tf, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax) {
+bool RuckigStep2::get_profile(Profile& profile, double tf, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax, Deadline deadline) {
     // Test all cases to get ones that match
     if (pf > p0) {
         if (time_up_none(profile, tf, p0, v0, a0, pf, vf, vMax, aMax, jMax)) {
@@ -1340,6 +1303,9 @@ bool RuckigStep2::get_profile(Profile& profile, double tf, double p0, double v0,
         } else if (time_down_acc0(profile, tf, p0, v0, a0, pf, vf, vMax, aMax, jMax)) {
             profile.type = Profile::Type::DOWN_ACC0;
 
+        } else if (time_vel_plateau(profile, tf, p0, v0, a0, pf, vf, vMax, aMax, jMax, deadline)) {
+            // The type is set by the reached limits of the plateau profile
+
         } else {
             return false;
         }
@@ -1393,6 +1359,9 @@ bool RuckigStep2::get_profile(Profile& profile, double tf, double p0, double v0,
         } else if (time_up_acc0(profile, tf, p0, v0, a0, pf, vf, vMax, aMax, jMax)) {
             profile.type = Profile::Type::UP_ACC0;
 
+        } else if (time_vel_plateau(profile, tf, p0, v0, a0, pf, vf, vMax, aMax, jMax, deadline)) {
+            // The type is set by the reached limits of the plateau profile
+
         } else {
             return false;
         }
@@ -1400,6 +1369,217 @@ bool RuckigStep2::get_profile(Profile& profile, double tf, double p0, double v0,
     return true;
 }
 
+bool RuckigStep2::get_next_duration(Profile& profile, double& tf, double p0, double v0, double a0, double pf, double vf, double vMax, double aMax, double jMax, Deadline deadline) {
+    // Exponential search for a reachable duration, then bisect towards the end of the blocked interval
+    double t_low = tf;
+    double step = std::max(next_duration_relative_step * tf, next_duration_min_step);
+    double t_high = tf + step;
+    size_t expansions {0};
+    while (!get_profile(profile, t_high, p0, v0, a0, pf, vf, vMax, aMax, jMax, deadline)) {
+        if (++expansions > next_duration_expansions || is_past(deadline)) {
+            return false;
+        }
+        t_low = t_high;
+        step *= 2;
+        t_high += step;
+    }
+
+    for (size_t i = 0; i < next_duration_bisections && t_high - t_low > next_duration_precision; i += 1) {
+        if (is_past(deadline)) {
+            return false;
+        }
+
+        const double t_mid = (t_low + t_high) / 2;
+        if (get_profile(profile, t_mid, p0, v0, a0, pf, vf, vMax, aMax, jMax, deadline)) {
+            t_high = t_mid;
+        } else {
+            t_low = t_mid;
+        }
+    }
+
+    tf = t_high;
+    return get_profile(profile, tf, p0, v0, a0, pf, vf, vMax, aMax, jMax, deadline);
+}
+
+bool VelocityStep1::time_up_acc0(Profile& profile, double p0, double v0, double a0, double vf, double af, double aMax, double jMax) {
+    profile.t[0] = (aMax - a0) / jMax;
+    profile.t[1] = (vf - v0 - (2 * std::pow(aMax, 2) - std::pow(a0, 2) - std::pow(af, 2)) / (2 * jMax)) / aMax;
+    profile.t[2] = (aMax - af) / jMax;
+    profile.t[3] = 0;
+    profile.t[4] = 0;
+    profile.t[5] = 0;
+    profile.t[6] = 0;
+
+    profile.set(p0, v0, a0, {jMax, 0, -jMax, 0, 0, 0, 0});
+    return profile.check_for_velocity(vf, af, aMax);
+}
+
+bool VelocityStep1::time_up_none(Profile& profile, double p0, double v0, double a0, double vf, double af, double aMax, double jMax) {
+    const double h1 = jMax * (vf - v0) + (std::pow(a0, 2) + std::pow(af, 2)) / 2;
+    if (h1 < 0.0) {
+        return false;
+    }
+
+    // The peak acceleration closer to the initial one is faster
+    const double h2 = (jMax > 0) ? std::sqrt(h1) : -std::sqrt(h1);
+    for (double a_peak: {-h2, h2}) {
+        profile.t[0] = (a_peak - a0) / jMax;
+        profile.t[1] = 0;
+        profile.t[2] = (a_peak - af) / jMax;
+        profile.t[3] = 0;
+        profile.t[4] = 0;
+        profile.t[5] = 0;
+        profile.t[6] = 0;
+
+        profile.set(p0, v0, a0, {jMax, 0, -jMax, 0, 0, 0, 0});
+        if (profile.check_for_velocity(vf, af, aMax)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool VelocityStep1::time_down_acc0(Profile& profile, double p0, double v0, double a0, double vf, double af, double aMax, double jMax) {
+    return time_up_acc0(profile, p0, v0, a0, vf, af, -aMax, -jMax);
+}
+
+bool VelocityStep1::time_down_none(Profile& profile, double p0, double v0, double a0, double vf, double af, double aMax, double jMax) {
+    return time_up_none(profile, p0, v0, a0, vf, af, -aMax, -jMax);
+}
+
+bool VelocityStep1::get_profile(Profile& profile, double p0, double v0, double a0, double vf, double af, double aMax, double jMax) {
+    // Both directions might be valid (e.g. for a non-zero initial acceleration), so keep the fastest one
+    Profile candidate = profile;
+    bool found {false};
+    auto keep_if_faster = [&](bool valid, Profile::Type type) {
+        if (valid && (!found || candidate.t_sum[6] < profile.t_sum[6])) {
+            candidate.type = type;
+            profile = candidate;
+            found = true;
+        }
+    };
+
+    keep_if_faster(time_up_acc0(candidate, p0, v0, a0, vf, af, aMax, jMax), Profile::Type::UP_ACC0);
+    keep_if_faster(time_up_none(candidate, p0, v0, a0, vf, af, aMax, jMax), Profile::Type::UP_NONE);
+    keep_if_faster(time_down_acc0(candidate, p0, v0, a0, vf, af, aMax, jMax), Profile::Type::DOWN_ACC0);
+    keep_if_faster(time_down_none(candidate, p0, v0, a0, vf, af, aMax, jMax), Profile::Type::DOWN_NONE);
+    return found;
+}
+
+//! Interval of durations where even the maximal velocity change (accelerating first) is smaller than dv
+inline bool get_blocked_interval_up(double t_min, double a0, double af, double dv, double aMax, double jMax, BlockedInterval& interval) {
+    // Maximal velocity change for a duration tf: jerk up to a peak acceleration, then down to af
+    const double h1 = 2 * (2 * jMax * dv + std::pow(a0, 2) + std::pow(af, 2));
+    if (h1 < 0.0) {
+        return false;
+    }
+
+    interval.left = std::max((-(a0 + af) - std::sqrt(h1)) / jMax, t_min);
+    interval.right = (-(a0 + af) + std::sqrt(h1)) / jMax;
+
+    // The peak acceleration is limited for durations longer than t_acc
+    const double t_acc = (2 * aMax - a0 - af) / jMax;
+    if (interval.right > t_acc) {
+        interval.right = t_acc + (dv - (2 * std::pow(aMax, 2) - std::pow(a0, 2) - std::pow(af, 2)) / (2 * jMax)) / aMax;
+    }
+
+    // The interval ending at t_min contains durations shorter than the minimal one
+    interval.right += 1e-12;
+    return interval.left < interval.right && interval.right > t_min + 1e-8;
+}
+
+bool VelocityStep1::get_blocked_interval(double t_min, double v0, double a0, double vf, double af, double aMax, double jMax, BlockedInterval& interval) {
+    return get_blocked_interval_up(t_min, a0, af, vf - v0, aMax, jMax, interval)
+        || get_blocked_interval_up(t_min, -a0, -af, v0 - vf, aMax, jMax, interval);
+}
+
+bool VelocityStep2::time_plateau(Profile& profile, double tf, double p0, double v0, double a0, double vf, double af, double aMax, double j1, double j3) {
+    // Velocity difference as a polynomial of the plateau acceleration: h1 * a^2 + h2 * a + h3 = 0
+    const double h1 = (1 / j3 - 1 / j1) / 2;
+    const double h2 = tf + a0 / j1 - af / j3;
+    const double h3 = -std::pow(a0, 2) / (2 * j1) + std::pow(af, 2) / (2 * j3) - (vf - v0);
+
+    std::array<double, 2> a_plateaus;
+    size_t length {0};
+    if (std::abs(h1) < 1e-12) {
+        if (std::abs(h2) < 1e-12) {
+            return false;
+        }
+        a_plateaus[length++] = -h3 / h2;
+
+    } else {
+        const double discriminant = std::max(std::pow(h2, 2) - 4 * h1 * h3, 0.0);
+        a_plateaus[length++] = (-h2 + std::sqrt(discriminant)) / (2 * h1);
+        a_plateaus[length++] = (-h2 - std::sqrt(discriminant)) / (2 * h1);
+    }
+
+    for (size_t i = 0; i < length; i += 1) {
+        profile.t[0] = (a_plateaus[i] - a0) / j1;
+        profile.t[2] = (af - a_plateaus[i]) / j3;
+        profile.t[1] = tf - profile.t[0] - profile.t[2];
+        profile.t[3] = 0;
+        profile.t[4] = 0;
+        profile.t[5] = 0;
+        profile.t[6] = 0;
+
+        profile.set(p0, v0, a0, {j1, 0, j3, 0, 0, 0, 0});
+        if (profile.check_for_velocity(vf, af, aMax)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool VelocityStep2::time_none(Profile& profile, double tf, double p0, double v0, double a0, double vf, double af, double aMax, double jMax) {
+    // Velocity difference as a polynomial of the peak acceleration, the jerk follows from the duration
+    const double h1 = 2 * tf;
+    const double h2 = -4 * (vf - v0);
+    const double h3 = 2 * (vf - v0) * (a0 + af) - tf * (std::pow(a0, 2) + std::pow(af, 2));
+    const double discriminant = std::pow(h2, 2) - 4 * h1 * h3;
+    if (discriminant < 0.0 || tf <= 0.0) {
+        return false;
+    }
+
+    for (double a_peak: {(-h2 + std::sqrt(discriminant)) / (2 * h1), (-h2 - std::sqrt(discriminant)) / (2 * h1)}) {
+        const double jf = (2 * a_peak - a0 - af) / tf;
+        if (std::abs(jf) > jMax + 1e-12 || std::abs(jf) < 1e-12) {
+            continue;
+        }
+
+        profile.t[0] = (a_peak - a0) / jf;
+        profile.t[1] = 0;
+        profile.t[2] = (a_peak - af) / jf;
+        profile.t[3] = 0;
+        profile.t[4] = 0;
+        profile.t[5] = 0;
+        profile.t[6] = 0;
+
+        profile.set(p0, v0, a0, {jf, 0, -jf, 0, 0, 0, 0});
+        if (profile.check_for_velocity(vf, af, aMax)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool VelocityStep2::get_profile(Profile& profile, double tf, double p0, double v0, double a0, double vf, double af, double aMax, double jMax) {
+    if (time_none(profile, tf, p0, v0, a0, vf, af, aMax, jMax)) {
+        profile.type = (profile.j[0] > 0) ? Profile::Type::UP_NONE : Profile::Type::DOWN_NONE;
+
+    } else if (time_plateau(profile, tf, p0, v0, a0, vf, af, aMax, jMax, -jMax)
+        || time_plateau(profile, tf, p0, v0, a0, vf, af, aMax, jMax, jMax)) {
+        profile.type = (profile.t[1] > 0) ? Profile::Type::UP_ACC0 : Profile::Type::UP_NONE;
+
+    } else if (time_plateau(profile, tf, p0, v0, a0, vf, af, aMax, -jMax, jMax)
+        || time_plateau(profile, tf, p0, v0, a0, vf, af, aMax, -jMax, -jMax)) {
+        profile.type = (profile.t[1] > 0) ? Profile::Type::DOWN_ACC0 : Profile::Type::DOWN_NONE;
+
+    } else {
+        return false;
+    }
+    return true;
+}
+
 inline double v_at_t(double v0, double a0, double j, double t) {
     return v0 + a0 * t + j * std::pow(t, 2) / 2;
 }
@@ -1508,4 +1688,38 @@ void RuckigStep1::get_brake_trajectory(double v0, double a0, double vMax, double
     }
 }
 
+void RuckigStatistics::reset() {
+    for (auto counter: {&calculations, &brakes, &step1_fallbacks, &step2_fallbacks, &failures}) {
+        counter->store(0, std::memory_order_relaxed);
+    }
+
+    for (auto& counter: calculation_histogram) {
+        counter.store(0, std::memory_order_relaxed);
+    }
+
+    for (auto& histogram: step1_histograms) {
+        for (auto& counter: histogram) {
+            counter.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+std::string CalculationError::to_string() const {
+    std::string message;
+    switch (result) {
+        case Result::Working:
+        case Result::Finished: return "No error";
+        case Result::ErrorInvalidInput: message = "Invalid input"; break;
+        case Result::ErrorExecutionTimeCalculation: message = "Error in Step 1 while calculating the time-optimal profile"; break;
+        case Result::ErrorSynchronizationCalculation: message = "Error in Step 2 while synchronizing the profile"; break;
+        case Result::ErrorCalculationTimeout: message = "Exceeded the computation budget"; break;
+        default: message = "Error"; break;
+    }
+
+    return message + " of DoF " + std::to_string(dof)
+        + " for profile input: " + std::to_string(p0) + ", " + std::to_string(v0) + ", " + std::to_string(a0)
+        + " targets: " + std::to_string(pf) + ", " + std::to_string(vf) + ", " + std::to_string(af)
+        + " limits: " + std::to_string(vMax) + ", " + std::to_string(aMax) + ", " + std::to_string(jMax);
+}
+
 } // namespace movex
@@ -0,0 +1,274 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <movex/otg/parameter.hpp>
+#include <movex/otg/quintic.hpp>
+#include <movex/otg/ruckig.hpp>
+#include <movex/otg/smoothie.hpp>
+
+#ifdef WITH_REFLEXXES
+#include <movex/otg/reflexxes.hpp>
+#endif
+
+
+using namespace movex;
+
+
+//! Latency distribution of a set of measurements in [µs]
+class Statistics {
+    std::vector<double> samples;
+
+    double percentile(double p) const {
+        const size_t index = std::min<size_t>(p * samples.size(), samples.size() - 1);
+        return samples[index];
+    }
+
+public:
+    void add(double sample) {
+        samples.push_back(sample);
+    }
+
+    void print(const std::string& name) {
+        if (samples.empty()) {
+            std::printf("  %-12s %10s\n", name.c_str(), "-");
+            return;
+        }
+
+        std::sort(samples.begin(), samples.end());
+        double sum {0.0};
+        for (double s: samples) {
+            sum += s;
+        }
+
+        std::printf("  %-12s %10.3f %10.3f %10.3f %10.3f %10.3f\n", name.c_str(), sum / samples.size(), percentile(0.5), percentile(0.99), percentile(0.999), samples.back());
+    }
+};
+
+
+enum class Distribution {
+    Random, ///< Similar to the unit tests: small state and limits in a moderate range
+    WorstCase, ///< States slightly exceeding the limits, non-zero target velocities and limits over two magnitudes
+};
+
+
+template<size_t DOFs>
+class InputGenerator {
+    using Vector = typename InputParameter<DOFs>::Vector;
+
+    std::mt19937 gen;
+    std::uniform_real_distribution<double> uniform {-1.0, 1.0};
+    std::uniform_real_distribution<double> exponent {-1.0, 1.0};
+
+    Vector random() {
+        Vector result;
+        for (size_t dof = 0; dof < DOFs; dof += 1) {
+            result[dof] = uniform(gen);
+        }
+        return result;
+    }
+
+    Vector random_limit(double offset) {
+        Vector result;
+        for (size_t dof = 0; dof < DOFs; dof += 1) {
+            result[dof] = 10 * std::abs(uniform(gen)) + offset;
+        }
+        return result;
+    }
+
+    Vector random_magnitude() {
+        Vector result;
+        for (size_t dof = 0; dof < DOFs; dof += 1) {
+            result[dof] = std::pow(10.0, exponent(gen));
+        }
+        return result;
+    }
+
+public:
+    explicit InputGenerator(unsigned int seed): gen(seed) { }
+
+    InputParameter<DOFs> operator()(Distribution distribution) {
+        InputParameter<DOFs> input;
+
+        switch (distribution) {
+        case Distribution::Random: {
+            input.current_position = random();
+            input.current_velocity = random();
+            input.current_acceleration = random();
+            input.target_position = random();
+            input.max_velocity = random_limit(0.1);
+            input.max_acceleration = random_limit(0.1);
+            input.max_jerk = random_limit(0.1);
+        } break;
+        case Distribution::WorstCase: {
+            input.max_velocity = random_magnitude();
+            input.max_acceleration = random_magnitude();
+            input.max_jerk = random_magnitude();
+            input.current_position = 10 * random();
+            input.current_velocity = 1.2 * input.max_velocity.cwiseProduct(random());
+            input.current_acceleration = 1.2 * input.max_acceleration.cwiseProduct(random());
+            input.target_position = 10 * random();
+            input.target_velocity = input.max_velocity.cwiseProduct(random());
+        } break;
+        }
+
+        return input;
+    }
+};
+
+
+//! Profile type names, ordered as Profile::Type
+constexpr std::array<const char*, 16> profile_type_names {
+    "UP_ACC0_ACC1_VEL", "UP_VEL", "UP_ACC0", "UP_ACC1", "UP_ACC0_ACC1", "UP_ACC0_VEL", "UP_ACC1_VEL", "UP_NONE",
+    "DOWN_ACC0_ACC1_VEL", "DOWN_VEL", "DOWN_ACC0", "DOWN_ACC1", "DOWN_ACC0_ACC1", "DOWN_ACC0_VEL", "DOWN_ACC1_VEL", "DOWN_NONE",
+};
+
+
+template<size_t DOFs, class OTGType>
+void benchmark(const std::string& name, Distribution distribution, size_t number_trajectories, unsigned int seed) {
+    constexpr size_t max_steps {1000}; // Per trajectory
+
+    OTGType otg {0.001};
+    InputGenerator<DOFs> generate {seed};
+    OutputParameter<DOFs> output;
+
+    Statistics calculation, step;
+    size_t errors {0};
+    std::map<Profile::Type, size_t> profile_types;
+
+    for (size_t i = 0; i < number_trajectories; i += 1) {
+        auto input = generate(distribution);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        Result result = otg.update(input, output);
+        auto stop = std::chrono::high_resolution_clock::now();
+        calculation.add(std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count() / 1000.0);
+
+        if (is_error(result)) {
+            errors += 1;
+            continue;
+        }
+
+        if constexpr (std::is_same_v<OTGType, Ruckig<DOFs>>) {
+            for (size_t dof = 0; dof < DOFs; dof += 1) {
+                profile_types[otg.get_trajectory().get_profile(dof).type] += 1;
+            }
+        }
+
+        for (size_t s = 0; s < max_steps && result == Result::Working; s += 1) {
+            output.pass_to_input(input);
+
+            start = std::chrono::high_resolution_clock::now();
+            result = otg.update(input, output);
+            stop = std::chrono::high_resolution_clock::now();
+            step.add(std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count() / 1000.0);
+        }
+    }
+
+    std::printf("%s with %zu DoF (%s input, %zu trajectories, %zu errors)\n", name.c_str(), DOFs, (distribution == Distribution::Random) ? "random" : "worst-case", number_trajectories, errors);
+    std::printf("  %-12s %10s %10s %10s %10s %10s\n", "[µs]", "mean", "p50", "p99", "p99.9", "max");
+    calculation.print("calculation");
+    step.print("step");
+
+    if (!profile_types.empty()) {
+        std::printf("  profiles:");
+        for (auto [type, count]: profile_types) {
+            std::printf(" %s %.1f%%", profile_type_names[static_cast<size_t>(type)], 100.0 * count / (number_trajectories * DOFs));
+        }
+        std::printf("\n");
+    }
+    std::printf("\n");
+}
+
+
+//! Streaming re-targets along a trajectory, with and without the profile cache on the same inputs
+template<size_t DOFs>
+void benchmark_profile_cache(size_t number_trajectories, unsigned int seed) {
+    constexpr size_t steps {100}; // Re-targets per trajectory
+    constexpr double delta_time {0.001};
+
+    Ruckig<DOFs> otg_cached {delta_time}, otg {delta_time};
+    otg_cached.use_profile_cache = true;
+    RuckigTrajectory<DOFs> trajectory_cached, trajectory;
+    InputGenerator<DOFs> generate {seed};
+
+    Statistics calculation_cached, calculation;
+    size_t faster {0}, slower {0}, errors {0};
+
+    for (size_t i = 0; i < number_trajectories; i += 1) {
+        auto input = generate(Distribution::Random);
+        const auto target_step = 1e-3 * input.max_velocity;
+
+        for (size_t s = 0; s < steps; s += 1) {
+            input.target_position += target_step;
+
+            auto start = std::chrono::high_resolution_clock::now();
+            const Result result_cached = otg_cached.calculate(input, trajectory_cached);
+            auto stop = std::chrono::high_resolution_clock::now();
+            calculation_cached.add(std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count() / 1000.0);
+
+            start = std::chrono::high_resolution_clock::now();
+            const Result result = otg.calculate(input, trajectory);
+            stop = std::chrono::high_resolution_clock::now();
+            calculation.add(std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count() / 1000.0);
+
+            if (is_error(result_cached) || is_error(result)) {
+                errors += 1;
+                break;
+            }
+
+            // Compare the resulting durations, which differ if a cached type gives another valid profile
+            if (trajectory_cached.get_duration() < trajectory.get_duration() - 1e-9) {
+                faster += 1;
+            } else if (trajectory_cached.get_duration() > trajectory.get_duration() + 1e-9) {
+                slower += 1;
+            }
+
+            trajectory.at_time(delta_time, input.current_position, input.current_velocity, input.current_acceleration);
+        }
+    }
+
+    std::printf("Ruckig profile cache with %zu DoF (%zu re-targets, %zu errors, cached duration %zu times shorter and %zu times longer)\n", DOFs, number_trajectories * steps, errors, faster, slower);
+    std::printf("  %-12s %10s %10s %10s %10s %10s\n", "[µs]", "mean", "p50", "p99", "p99.9", "max");
+    calculation_cached.print("cached");
+    calculation.print("uncached");
+    std::printf("\n");
+}
+
+
+template<size_t DOFs>
+void benchmark_all(size_t number_trajectories, unsigned int seed) {
+    for (auto distribution: {Distribution::Random, Distribution::WorstCase}) {
+        benchmark<DOFs, Ruckig<DOFs>>("Ruckig", distribution, number_trajectories, seed);
+        benchmark<DOFs, Quintic<DOFs>>("Quintic", distribution, number_trajectories, seed);
+        benchmark<DOFs, Smoothie<DOFs>>("Smoothie", distribution, number_trajectories, seed);
+#ifdef WITH_REFLEXXES
+        benchmark<DOFs, Reflexxes<DOFs>>("Reflexxes", distribution, number_trajectories, seed);
+#endif
+    }
+    benchmark_profile_cache<DOFs>(number_trajectories / 16, seed);
+}
+
+
+template<size_t... DOFs>
+void benchmark_dofs(std::index_sequence<DOFs...>, size_t number_trajectories, unsigned int seed) {
+    (benchmark_all<DOFs + 1>(number_trajectories, seed), ...);
+}
+
+
+int main(int argc, char **argv) {
+    // Usage: benchmark [number of trajectories] [seed]
+    const size_t number_trajectories = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 4096;
+    const unsigned int seed = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 42;
+
+    benchmark_dofs(std::make_index_sequence<7>(), number_trajectories, seed);
+}
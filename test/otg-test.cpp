@@ -1,12 +1,19 @@
 #define CATCH_CONFIG_MAIN
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <optional>
 #include <random>
 
 #include <catch2/catch.hpp>
 #include <Eigen/Core>
 
+#include <movex/otg/async_ruckig.hpp>
 #include <movex/otg/parameter.hpp>
 #include <movex/otg/quintic.hpp>
 #include <movex/otg/ruckig.hpp>
+#include <movex/otg/ruckig/roots.hpp>
+#include <movex/otg/smoothie.hpp>
 
 #ifdef WITH_REFLEXXES
 #include <movex/otg/reflexxes.hpp>
@@ -97,6 +104,28 @@ void check_comparison(OTGType& otg, InputParameter<DOFs>& input, OTGCompType& ot
 }
 
 
+//! Random current state and target position within [-1, 1], and random limits between min_limit and min_limit + 10. With a limit factor,
+//! the current velocity and acceleration are scaled by their limits instead, e.g. to start beyond the limits. Seeded by srand.
+template<size_t DOFs>
+void random_input(InputParameter<DOFs>& input, double min_limit = 0.1, std::optional<double> limit_factor = std::nullopt) {
+    using Vector = typename InputParameter<DOFs>::Vector;
+    const size_t n = input.get_degrees_of_freedom();
+
+    input.max_velocity = 10 * Vector::Random(n).array().abs() + min_limit;
+    input.max_acceleration = 10 * Vector::Random(n).array().abs() + min_limit;
+    input.max_jerk = 10 * Vector::Random(n).array().abs() + min_limit;
+    input.current_position = Vector::Random(n);
+    input.current_velocity = Vector::Random(n);
+    input.current_acceleration = Vector::Random(n);
+    input.target_position = Vector::Random(n);
+
+    if (limit_factor) {
+        input.current_velocity = limit_factor.value() * input.max_velocity.cwiseProduct(input.current_velocity);
+        input.current_acceleration = limit_factor.value() * input.max_acceleration.cwiseProduct(input.current_acceleration);
+    }
+}
+
+
 TEST_CASE("Quintic") {
     InputParameter<3> input;
     input.current_position = {0.0, 0.0, 0.0};
@@ -119,6 +148,30 @@ TEST_CASE("Quintic") {
     check(otg, input, 3.110);
 }
 
+TEST_CASE("Smoothie") {
+    InputParameter<3> input;
+    input.current_position = {0.0, 0.0, 0.0};
+    input.target_position = {1.0, -0.5, 0.2};
+    input.max_velocity = {1.0, 1.0, 1.0};
+    input.max_acceleration = {1.0, 1.0, 1.0};
+
+    Smoothie<3> otg {0.005};
+    OutputParameter<3> output;
+    CHECK( otg.update(input, output) == Result::Working );
+
+    // The sampled velocity and acceleration are the derivatives of the sampled position
+    constexpr double dt {1e-4};
+    constexpr size_t n {40000};
+    Eigen::MatrixXd positions(n, 3), velocities(n, 3), accelerations(n, 3);
+    otg.sample(0.0, dt, positions, velocities, accelerations);
+    CHECK( velocities.cwiseAbs().maxCoeff() > 0.1 );
+    for (size_t i = 1; i + 1 < n; i += 1) {
+        CHECK( ((positions.row(i + 1) - positions.row(i - 1)) / (2 * dt) - velocities.row(i)).cwiseAbs().maxCoeff() < 1e-3 );
+        CHECK( ((velocities.row(i + 1) - velocities.row(i - 1)) / (2 * dt) - accelerations.row(i)).cwiseAbs().maxCoeff() < 1e-2 );
+    }
+    CHECK( velocities.row(n - 1).norm() < 1e-12 );
+}
+
 TEST_CASE("Ruckig") {
     SECTION("Known examples") {
         Ruckig<3> otg {0.005};
@@ -201,18 +254,971 @@ TEST_CASE("Ruckig") {
         std::uniform_real_distribution<double> dist(0.0, 1.0);
 
         for (size_t i = 0; i < 32*1024; i += 1) {
-            input.current_position = Vec::Random();
-            input.current_velocity = dist(gen) < 0.9 ? (Vec)Vec::Random() : (Vec)Vec::Zero();
-            input.current_acceleration = dist(gen) < 0.8 ? (Vec)Vec::Random() : (Vec)Vec::Zero();
-            input.target_position = Vec::Random();
-            input.max_velocity = 10 * Vec::Random().array().abs() + 0.1;
-            input.max_acceleration = 10 * Vec::Random().array().abs() + 0.1;
-            input.max_jerk = 10 * Vec::Random().array().abs() + 0.1;
+            random_input(input);
+            if (dist(gen) >= 0.9) {
+                input.current_velocity.setZero();
+            }
+            if (dist(gen) >= 0.8) {
+                input.current_acceleration.setZero();
+            }
+
+            check_calculation(otg, input);
+        }
+    }
+
+    SECTION("Random input with target velocity and 3 DoF") {
+        Ruckig<3> otg {0.005};
+        InputParameter<3> input;
+
+        srand(43);
+        for (size_t i = 0; i < 4*1024; i += 1) {
+            random_input(input);
+            input.target_velocity = input.max_velocity.cwiseProduct(Vec::Random());
+
+            check_calculation(otg, input);
+
+            // All DoFs reach their target at the same time
+            const auto& trajectory = otg.get_trajectory();
+            Vec p, v, a;
+            trajectory.at_time(trajectory.get_duration(), p, v, a);
+            CHECK( (p - input.target_position).cwiseAbs().maxCoeff() < 1e-6 );
+            CHECK( (v - input.target_velocity).cwiseAbs().maxCoeff() < 1e-6 );
+            for (size_t dof = 0; dof < 3; dof += 1) {
+                const auto& profile = trajectory.get_profile(dof);
+                CHECK( profile.t_sum[6] + profile.t_brake.value_or(0.0) == Approx(trajectory.get_duration()) );
+            }
+        }
+
+        // The type of a plateau profile names the limits it reaches
+        std::default_random_engine gen;
+        std::uniform_real_distribution<double> dist(-1.0, 1.0);
+        size_t number_plateaus {0};
+        for (size_t i = 0; i < 4*1024; i += 1) {
+            const double vMax = 10 * std::abs(dist(gen)) + 0.1, aMax = 10 * std::abs(dist(gen)) + 0.1, jMax = 10 * std::abs(dist(gen)) + 0.1;
+            const double tf = 5 * std::abs(dist(gen)), p0 = dist(gen), v0 = vMax * dist(gen), a0 = 0.5 * aMax * dist(gen), pf = dist(gen), vf = vMax * dist(gen);
+            Profile profile;
+            if (!RuckigStep2::time_vel_plateau(profile, tf, p0, v0, a0, pf, vf, vMax, aMax, jMax)) {
+                continue;
+            }
+
+            // The numeric search gives up after its deadline
+            Profile profile_late;
+            CHECK_FALSE( RuckigStep2::time_vel_plateau(profile_late, tf, p0, v0, a0, pf, vf, vMax, aMax, jMax, std::chrono::high_resolution_clock::now() - std::chrono::seconds(1)) );
+
+            number_plateaus += 1;
+            const auto type = profile.type;
+            const bool is_vel = (type == Profile::Type::UP_VEL || type == Profile::Type::DOWN_VEL || type == Profile::Type::UP_ACC0_VEL || type == Profile::Type::DOWN_ACC0_VEL
+                || type == Profile::Type::UP_ACC1_VEL || type == Profile::Type::DOWN_ACC1_VEL || type == Profile::Type::UP_ACC0_ACC1_VEL || type == Profile::Type::DOWN_ACC0_ACC1_VEL);
+            CHECK( is_vel == (profile.t[3] > 0.0 && std::abs(profile.v[3]) > vMax - 1e-9) );
+        }
+        CHECK( number_plateaus > 0 );
+    }
+
+    SECTION("Target acceleration with target position") {
+        Ruckig<3> otg {0.005};
+        InputParameter<3> input;
+
+        input.current_position = {0.0, 0.0, 0.0};
+        input.current_velocity = {0.0, 0.0, 0.0};
+        input.current_acceleration = {0.0, 0.0, 0.0};
+        input.target_position = {1.0, 1.0, 1.0};
+        input.target_velocity = {0.5, 0.5, 0.5};
+        input.target_acceleration = {0.0, 0.05, 0.0};
+        input.max_velocity = {1.0, 1.0, 1.0};
+        input.max_acceleration = {2.0, 2.0, 2.0};
+        input.max_jerk = {1.0, 1.0, 1.0};
+
+        RuckigTrajectory<3> trajectory;
+        CHECK( otg.calculate(input, trajectory) == Result::ErrorInvalidInput );
+        CHECK( otg.get_error().dof == 1 );
+
+        input.target_acceleration = {0.0, 0.0, 0.0};
+        CHECK( otg.calculate(input, trajectory) == Result::Working );
+    }
+
+    SECTION("Minimum duration with 3 DoF") {
+        Ruckig<3> otg {0.005};
+
+        InputParameter<3> input;
+        input.current_position = {0.0, 0.0, 0.0};
+        input.target_position = {1.0, 1.0, 1.0};
+        input.max_velocity = {1.0, 1.0, 1.0};
+        input.max_acceleration = {1.0, 1.0, 1.0};
+        input.max_jerk = {1.0, 1.0, 1.0};
+        input.minimum_duration = 5.0;
+        check(otg, input, 5.0);
+
+        // Hold the position
+        input.current_velocity = {0.0, 0.0, 0.0};
+        input.current_acceleration = {0.0, 0.0, 0.0};
+        check(otg, input, 5.0);
+
+        srand(44);
+        for (size_t i = 0; i < 1024; i += 1) {
+            random_input(input);
+            input.minimum_duration = 4 * std::abs(Vec::Random()[0]);
 
             check_calculation(otg, input);
+
+            const auto& trajectory = otg.get_trajectory();
+            CHECK( trajectory.get_duration() >= input.minimum_duration.value() );
+
+            Vec p, v, a;
+            trajectory.at_time(trajectory.get_duration(), p, v, a);
+            CHECK( (p - input.target_position).cwiseAbs().maxCoeff() < 1e-6 );
         }
     }
 
+    SECTION("Phase synchronization with 3 DoF") {
+        Ruckig<3> otg {0.005};
+        InputParameter<3> input;
+
+        srand(46);
+        for (size_t i = 0; i < 1024; i += 1) {
+            // Collinear input within the limits, so that no DoF needs to brake
+            const Vec direction = Vec::Random();
+            random_input(input, 1.1);
+            input.synchronization = InputParameter<3>::Synchronization::Phase;
+            input.current_velocity = 0.1 * Vec::Random()[0] * direction;
+            input.current_acceleration = 0.1 * Vec::Random()[0] * direction;
+            input.target_position = input.current_position + Vec::Random()[0] * direction;
+
+            check_calculation(otg, input);
+            const auto trajectory = otg.get_trajectory();
+
+            // Straight line with the same direction for all DoFs
+            Vec p, v, a;
+            for (double t = 0.0; t < trajectory.get_duration(); t += 0.05) {
+                trajectory.at_time(t, p, v, a);
+                const Vec offset = p - input.current_position;
+                CHECK( (offset - offset.dot(direction) / direction.squaredNorm() * direction).norm() < 1e-8 );
+                CHECK( (v.cwiseAbs().array() <= input.max_velocity.array() + 1e-8).all() );
+            }
+
+            trajectory.at_time(trajectory.get_duration(), p, v, a);
+            CHECK( (p - input.target_position).cwiseAbs().maxCoeff() < 1e-6 );
+
+            // Not faster than time synchronization
+            RuckigTrajectory<3> time_synchronized;
+            input.synchronization = InputParameter<3>::Synchronization::Time;
+            otg.calculate(input, time_synchronized);
+            CHECK( trajectory.get_duration() >= time_synchronized.get_duration() - 1e-9 );
+        }
+
+        // A brake of the reference DoF is counted for each moving DoF, as with time synchronization
+        otg.statistics = std::make_shared<RuckigStatistics>();
+        input.synchronization = InputParameter<3>::Synchronization::Phase;
+        input.current_position = {0.0, 0.0, 0.0};
+        input.current_velocity = {2.0, 1.0, 0.0};
+        input.current_acceleration = {0.0, 0.0, 0.0};
+        input.target_position = {1.0, 0.5, 0.0};
+        input.max_velocity = {1.0, 1.0, 1.0};
+        input.max_acceleration = {2.0, 2.0, 2.0};
+        input.max_jerk = {4.0, 4.0, 4.0};
+
+        RuckigTrajectory<3> trajectory;
+        CHECK( otg.calculate(input, trajectory) == Result::Working );
+        CHECK( otg.statistics->brakes == 2 );
+
+        // The collinearity is checked relative to the magnitude of the motion, so that a small motion in other units isn't collinear
+        RuckigTrajectory<3> time_synchronized;
+        Vec p, v, a, p_time, v_time, a_time;
+        input.current_velocity = {2e-9, -1e-9, 0.5e-9};
+        input.target_position = {1e-9, 1e-9, 1e-9};
+        input.max_velocity = {1e-9, 1e-9, 1e-9};
+        input.max_acceleration = {2e-9, 2e-9, 2e-9};
+        input.max_jerk = {4e-9, 4e-9, 4e-9};
+        CHECK( otg.calculate(input, trajectory) == Result::Working );
+        input.synchronization = InputParameter<3>::Synchronization::Time;
+        CHECK( otg.calculate(input, time_synchronized) == Result::Working );
+        trajectory.at_time(trajectory.get_duration() / 2, p, v, a);
+        time_synchronized.at_time(trajectory.get_duration() / 2, p_time, v_time, a_time);
+        CHECK( p == p_time );
+    }
+
+    SECTION("Profile cache with 3 DoF") {
+        Ruckig<3> otg {0.005};
+        Ruckig<3> otg_uncached {0.005};
+        otg.use_profile_cache = true;
+        InputParameter<3> input;
+        OutputParameter<3> output, output_uncached;
+
+        srand(46);
+        for (size_t i = 0; i < 1024; i += 1) {
+            random_input(input);
+
+            otg.update(input, output);
+            otg_uncached.update(input, output_uncached);
+            CHECK( output.duration <= output_uncached.duration + 1e-9 );
+        }
+
+        // Re-targeting while following the trajectory
+        Ruckig<3> otg_stream {0.005};
+        otg_stream.use_profile_cache = true;
+        input.current_position = Vec::Zero();
+        input.current_velocity = Vec::Zero();
+        input.current_acceleration = Vec::Zero();
+        input.max_velocity = Vec::Ones();
+        input.max_acceleration = Vec::Ones();
+        input.max_jerk = Vec::Ones();
+        for (size_t i = 0; i < 256; i += 1) {
+            input.target_position = Vec::Ones() * (1.0 + 1e-3 * i);
+            otg_stream.update(input, output);
+            input.current_position = output.new_position;
+            input.current_velocity = output.new_velocity;
+            input.current_acceleration = output.new_acceleration;
+        }
+        CHECK( otg_stream.profile_caches[0].hit_rate() > 0.9 );
+
+        // Without the cache, the trajectory doesn't depend on the previous calculations
+        Ruckig<3> otg_fresh {0.005};
+        otg_uncached.update(input, output_uncached);
+        otg_fresh.update(input, output);
+        CHECK( output.duration == output_uncached.duration );
+        CHECK( otg_uncached.get_trajectory().get_profile(0).type == otg_fresh.get_trajectory().get_profile(0).type );
+        CHECK( otg_fresh.profile_caches[0].hits + otg_fresh.profile_caches[0].misses == 0 );
+    }
+
+    SECTION("Trajectory cursor with 3 DoF") {
+        Ruckig<3> otg {0.005};
+        RuckigTrajectory<3> trajectory;
+        InputParameter<3> input;
+
+        srand(48);
+        for (size_t i = 0; i < 256; i += 1) {
+            random_input(input);
+            input.enabled = {true, i % 8 != 0, true};
+
+            REQUIRE( otg.calculate(input, trajectory) == Result::Working );
+
+            Vec p, v, a, p_cursor, v_cursor, a_cursor;
+            auto cursor = trajectory.cursor();
+            for (double t = 0.0; t < trajectory.get_duration() + 0.01; t += 0.01) {
+                trajectory.at_time(t, p, v, a);
+                cursor.at_time(trajectory, t, p_cursor, v_cursor, a_cursor);
+                CHECK( p_cursor.isApprox(p) );
+                CHECK( v_cursor.isApprox(v) );
+                CHECK( a_cursor.isApprox(a) );
+            }
+
+            // Backward in time restarts the cursor
+            trajectory.at_time(0.0, p, v, a);
+            cursor.at_time(trajectory, 0.0, p_cursor, v_cursor, a_cursor);
+            CHECK( p_cursor.isApprox(p) );
+            CHECK( p.isApprox(input.current_position) );
+            CHECK( v.isApprox(input.current_velocity) );
+        }
+
+        // A copy of the generator samples its own trajectory, even if the original is changed or destroyed
+        auto otg_original = std::make_unique<Ruckig<3>>(0.005);
+        OutputParameter<3> output, output_copy;
+        REQUIRE( otg_original->update(input, output) == Result::Working );
+        const RuckigTrajectory<3> trajectory_original = otg_original->get_trajectory();
+        output_copy = output;
+
+        Ruckig<3> otg_copy = *otg_original;
+        InputParameter<3> input_other = input;
+        input_other.target_position = Vec::Random();
+        otg_original->update(input_other, output);
+        otg_original.reset();
+
+        InputParameter<3> input_copy = input;
+        for (size_t i = 1; i <= 10; i += 1) {
+            output_copy.pass_to_input(input_copy);
+            REQUIRE( otg_copy.update(input_copy, output_copy) == Result::Working );
+
+            Vec p, v, a;
+            trajectory_original.at_time(0.005 * i, p, v, a);
+            CHECK( output_copy.new_position.isApprox(p) );
+            CHECK( output_copy.new_velocity.isApprox(v) );
+        }
+    }
+
+    SECTION("Velocity interface with 3 DoF") {
+        Ruckig<3> otg {0.005};
+
+        InputParameter<3> input;
+        input.type = InputParameter<3>::Type::Velocity;
+        input.current_position = {0.0, 0.0, 0.0};
+        input.current_velocity = {0.0, 0.0, 0.0};
+        input.current_acceleration = {0.0, 0.0, 0.0};
+        input.target_velocity = {1.0, 1.0, 1.0};
+        input.max_acceleration = {1.0, 1.0, 1.0};
+        input.max_jerk = {1.0, 1.0, 1.0};
+        check(otg, input, 2.0);
+
+        input.current_velocity = {0.0, 0.0, 0.0};
+        input.target_velocity = {2.0, -0.5, 0.0};
+        check(otg, input, 3.0);
+
+        srand(49);
+        for (size_t i = 0; i < 1024; i += 1) {
+            random_input(input);
+            input.target_velocity = Vec::Random();
+            input.target_acceleration = input.max_acceleration.cwiseProduct(Vec::Random());
+
+            CAPTURE( input.current_velocity );
+            CAPTURE( input.current_acceleration );
+            CAPTURE( input.target_velocity );
+            CAPTURE( input.target_acceleration );
+            CAPTURE( input.max_acceleration );
+            CAPTURE( input.max_jerk );
+
+            OutputParameter<3> output;
+            REQUIRE_FALSE( is_error(otg.update(input, output)) );
+
+            const auto& trajectory = otg.get_trajectory();
+            Vec p, v, a;
+            trajectory.at_time(trajectory.get_duration(), p, v, a);
+            CHECK( v.isApprox(input.target_velocity, 1e-8) );
+            CHECK( (a - input.target_acceleration).cwiseAbs().maxCoeff() < 1e-8 );
+
+            // Acceleration within limits after braking
+            double t_brake {0.0};
+            for (size_t dof = 0; dof < 3; dof += 1) {
+                t_brake = std::max(t_brake, trajectory.get_profile(dof).t_brake.value_or(0.0));
+            }
+            for (double t = t_brake; t < trajectory.get_duration(); t += 0.01) {
+                trajectory.at_time(t, p, v, a);
+                CHECK( (a.cwiseAbs().array() <= input.max_acceleration.array() + 1e-9).all() );
+            }
+        }
+    }
+
+    SECTION("Input change detection with 3 DoF") {
+        Ruckig<3> otg {0.005};
+        InputParameter<3> input;
+        input.current_position = {0.0, 0.0, 0.0};
+        input.target_position = {1.0, -1.0, 0.5};
+        input.max_velocity = {1.0, 1.0, 1.0};
+        input.max_acceleration = {1.0, 1.0, 1.0};
+        input.max_jerk = {1.0, 1.0, 1.0};
+
+        // Untracked inputs are compared by value
+        InputParameter<3> last = input;
+        CHECK( input.get_version() == 0 );
+        CHECK_FALSE( input.has_changed(last) );
+        input.max_jerk[0] = 2.0;
+        CHECK( input.has_changed(last) );
+
+        // Tracked inputs are compared by version and current state
+        input.set_limits(input.max_velocity, input.max_acceleration, Vec {1.0, 1.0, 1.0});
+        CHECK( input.get_version() > 0 );
+        last = input;
+        CHECK_FALSE( input.has_changed(last) );
+        input.current_position[0] = 0.5;
+        CHECK( input.has_changed(last) );
+        input.current_position[0] = 0.0;
+        input.current_velocity[1] = 0.5;
+        CHECK( input.has_changed(last) );
+        input.current_velocity[1] = 0.0;
+        CHECK_FALSE( input.has_changed(last) );
+        input.set_target_position({1.0, -1.0, 0.5});
+        CHECK( input.has_changed(last) );
+
+        // All remaining fields have setters
+        last = input;
+        input.set_target_acceleration({0.0, 0.0, 0.0});
+        CHECK( input.has_changed(last) );
+        last = input;
+        input.set_type(InputParameter<3>::Type::Position);
+        CHECK( input.has_changed(last) );
+        last = input;
+        input.set_synchronization(InputParameter<3>::Synchronization::Time);
+        CHECK( input.has_changed(last) );
+        last = input;
+        input.set_duration_discretization(InputParameter<3>::DurationDiscretization::Continuous);
+        CHECK( input.has_changed(last) );
+
+        // The fed-back output isn't a change, also after the trajectory has finished
+        OutputParameter<3> output;
+        otg.statistics = std::make_shared<RuckigStatistics>();
+        while (otg.update(input, output) == Result::Working) {
+            output.pass_to_input(input);
+        }
+        CHECK( output.duration == Approx(3.1748) );
+        CHECK( output.new_position.isApprox(input.target_position) );
+        output.pass_to_input(input);
+        CHECK( otg.update(input, output) == Result::Finished );
+        CHECK( otg.statistics->calculations == 1 );
+
+        input.set_target_position({0.0, 0.0, 0.0});
+        CHECK( otg.update(input, output) == Result::Working );
+        CHECK( output.duration > 3.0 );
+    }
+
+    SECTION("Error reporting with 3 DoF") {
+        Ruckig<3> otg {0.005};
+        RuckigTrajectory<3> trajectory;
+        InputParameter<3> input;
+        input.current_position = {0.0, 0.0, 0.0};
+        input.target_position = {1.0, 1.0, 1.0};
+        input.max_velocity = {1.0, 1.0, 1.0};
+        input.max_acceleration = {1.0, 1.0, 1.0};
+        input.max_jerk = {1.0, 1.0, 1.0};
+        CHECK( otg.calculate(input, trajectory) == Result::Working );
+
+        input.target_velocity = {0.0, 2.0, 0.0};
+        CHECK( otg.calculate(input, trajectory) == Result::ErrorInvalidInput );
+        CHECK( otg.get_error().result == Result::ErrorInvalidInput );
+        CHECK( otg.get_error().dof == 1 );
+        CHECK( otg.get_error().vf == 2.0 );
+        CHECK_FALSE( otg.get_error().to_string().empty() );
+
+        OutputParameter<3> output;
+        input.target_velocity = {0.0, 0.0, 0.0};
+        input.max_jerk = {1.0, 1.0, -1.0};
+        CHECK( otg.update(input, output) == Result::ErrorInvalidInput );
+        CHECK( otg.get_error().dof == 2 );
+    }
+
+    SECTION("Asynchronous calculation with 3 DoF") {
+        Ruckig<3> otg {0.005};
+        AsyncRuckig<3> async_otg {0.005};
+        RuckigTrajectory<3> trajectory;
+        InputParameter<3> input;
+        OutputParameter<3> output, output_async;
+
+        CHECK( async_otg.update(output_async) == Result::Error );
+
+        srand(50);
+        for (size_t i = 0; i < 32; i += 1) {
+            random_input(input);
+
+            async_otg.request(input);
+            while (!async_otg.switch_trajectory()) {
+                std::this_thread::yield();
+            }
+
+            REQUIRE( otg.calculate(input, trajectory) == Result::Working );
+            REQUIRE( async_otg.get_trajectory() != nullptr );
+            CHECK( async_otg.get_trajectory()->get_duration() == Approx(trajectory.get_duration()) );
+
+            Result result;
+            for (double t = 0.0; (result = async_otg.update(output_async)) == Result::Working; t += 0.005) {
+                trajectory.at_time(t, output.new_position, output.new_velocity, output.new_acceleration);
+                CHECK( output_async.new_position.isApprox(output.new_position) );
+            }
+            CHECK( result == Result::Finished );
+            CHECK( output_async.new_position.isApprox(input.target_position) );
+            CHECK( async_otg.get_last_result() == Result::Working );
+        }
+
+        // A failed calculation keeps the current trajectory
+        const RuckigTrajectory<3>* current = async_otg.get_trajectory();
+        input.max_jerk[1] = -1.0;
+        async_otg.request(input);
+        while (async_otg.get_last_result() == Result::Working) {
+            std::this_thread::yield();
+        }
+        CHECK( async_otg.get_last_result() == Result::ErrorInvalidInput );
+        CHECK( !async_otg.switch_trajectory() );
+        CHECK( async_otg.get_trajectory() == current );
+        CHECK( async_otg.update(output_async) == Result::Finished );
+        CHECK( output_async.new_position.isApprox(input.target_position) );
+    }
+
+    SECTION("Statistics with 3 DoF") {
+        Ruckig<3> otg {0.005};
+        otg.statistics = std::make_shared<RuckigStatistics>();
+        RuckigTrajectory<3> trajectory;
+        InputParameter<3> input;
+
+        CHECK( RuckigStatistics::bin(0.1) == 0 );
+        CHECK( RuckigStatistics::bin(1.5) == 4 );
+        CHECK( RuckigStatistics::bin(1e9) == RuckigStatistics::number_bins - 1 );
+
+        srand(51);
+        constexpr size_t number_calculations {256};
+        for (size_t i = 0; i < number_calculations; i += 1) {
+            random_input(input, 0.1, 1.5);
+
+            REQUIRE( otg.calculate(input, trajectory) == Result::Working );
+        }
+
+        auto sum = [](const RuckigStatistics::Histogram& histogram) {
+            return std::accumulate(histogram.begin(), histogram.end(), uint64_t {0});
+        };
+
+        uint64_t step1_sum {0};
+        for (size_t type = 0; type < RuckigStatistics::number_types; type += 1) {
+            step1_sum += sum(otg.statistics->get_step1_histogram(static_cast<Profile::Type>(type)));
+        }
+
+        CHECK( otg.statistics->calculations == number_calculations );
+        CHECK( sum(otg.statistics->get_calculation_histogram()) == number_calculations );
+        CHECK( step1_sum == 3 * number_calculations );
+        CHECK( otg.statistics->brakes > 0 );
+        CHECK( otg.statistics->failures == 0 );
+
+        input.max_jerk[1] = -1.0;
+        CHECK( otg.calculate(input, trajectory) == Result::ErrorInvalidInput );
+        CHECK( otg.statistics->failures == 1 );
+        CHECK( otg.statistics->calculations == number_calculations );
+
+        otg.statistics->reset();
+        CHECK( otg.statistics->calculations == 0 );
+        CHECK( sum(otg.statistics->get_calculation_histogram()) == 0 );
+    }
+
+    SECTION("Dynamic DoFs with 3 DoF") {
+        Ruckig<3> otg {0.005};
+        Ruckig<0> otg_dynamic {3, 0.005};
+        InputParameter<3> input;
+        InputParameter<0> input_dynamic {3};
+        OutputParameter<3> output;
+        OutputParameter<0> output_dynamic {3};
+        CHECK( otg_dynamic.degrees_of_freedom == 3 );
+        static_assert(InputParameter<3>::degrees_of_freedom == 3);
+        CHECK( input.get_degrees_of_freedom() == 3 );
+        CHECK( input_dynamic.get_degrees_of_freedom() == 3 );
+
+        srand(52);
+        for (size_t i = 0; i < 256; i += 1) {
+            random_input(input);
+            input.synchronization = (i % 2 == 0) ? InputParameter<3>::Synchronization::Time : InputParameter<3>::Synchronization::Phase;
+
+            input_dynamic.current_position = input.current_position;
+            input_dynamic.current_velocity = input.current_velocity;
+            input_dynamic.current_acceleration = input.current_acceleration;
+            input_dynamic.target_position = input.target_position;
+            input_dynamic.max_velocity = input.max_velocity;
+            input_dynamic.max_acceleration = input.max_acceleration;
+            input_dynamic.max_jerk = input.max_jerk;
+            input_dynamic.synchronization = (i % 2 == 0) ? InputParameter<0>::Synchronization::Time : InputParameter<0>::Synchronization::Phase;
+
+            REQUIRE( otg.update(input, output) == Result::Working );
+            REQUIRE( otg_dynamic.update(input_dynamic, output_dynamic) == Result::Working );
+            CHECK( output_dynamic.duration == output.duration );
+            CHECK( output_dynamic.new_position == output.new_position );
+
+            otg.atTime(output.duration / 2, output);
+            otg_dynamic.atTime(output.duration / 2, output_dynamic);
+            CHECK( output_dynamic.new_position == output.new_position );
+            CHECK( output_dynamic.new_velocity == output.new_velocity );
+        }
+
+        // The number of DoFs of the input needs to match the generator
+        InputParameter<0> input_mismatch {2};
+        input_mismatch.current_position = Vec2::Zero();
+        input_mismatch.target_position = Vec2::Ones();
+        input_mismatch.max_velocity = Vec2::Ones();
+        input_mismatch.max_acceleration = Vec2::Ones();
+        input_mismatch.max_jerk = Vec2::Ones();
+        CHECK( otg_dynamic.update(input_mismatch, output_dynamic) == Result::ErrorInvalidInput );
+    }
+
+    SECTION("Position extrema with 3 DoF") {
+        Ruckig<3> otg {0.005};
+        RuckigTrajectory<3> trajectory;
+        InputParameter<3> input;
+        Vec new_position, new_velocity, new_acceleration;
+
+        srand(53);
+        for (size_t i = 0; i < 256; i += 1) {
+            random_input(input, 0.1, 1.2);
+            input.target_velocity = input.max_velocity.cwiseProduct(Vec::Random());
+            input.enabled = {true, true, (i % 4 != 0)};
+
+            REQUIRE( otg.calculate(input, trajectory) == Result::Working );
+            const auto extrema = trajectory.get_position_extrema();
+
+            // Compare with the sampled trajectory
+            Vec sampled_min = Vec::Constant(std::numeric_limits<double>::infinity());
+            Vec sampled_max = Vec::Constant(-std::numeric_limits<double>::infinity());
+            const double duration = trajectory.get_duration();
+            for (size_t step = 0; step <= 2000; step += 1) {
+                trajectory.at_time(step * duration / 2000, new_position, new_velocity, new_acceleration);
+                sampled_min = sampled_min.cwiseMin(new_position);
+                sampled_max = sampled_max.cwiseMax(new_position);
+            }
+
+            for (size_t dof = 0; dof < 3; dof += 1) {
+                // At an extremum within a segment, the velocity is zero
+                const double dt = duration / 2000;
+                const double margin = 1.2 * input.max_acceleration[dof] * std::pow(dt, 2) + input.max_jerk[dof] * std::pow(dt, 3) + 1e-9;
+
+                CHECK( extrema[dof].min <= sampled_min[dof] + 1e-9 );
+                CHECK( extrema[dof].max >= sampled_max[dof] - 1e-9 );
+                CHECK( extrema[dof].min == Approx(sampled_min[dof]).margin(margin) );
+                CHECK( extrema[dof].max == Approx(sampled_max[dof]).margin(margin) );
+
+                trajectory.at_time(extrema[dof].t_min, new_position, new_velocity, new_acceleration);
+                CHECK( new_position[dof] == Approx(extrema[dof].min).margin(1e-9) );
+                trajectory.at_time(extrema[dof].t_max, new_position, new_velocity, new_acceleration);
+                CHECK( new_position[dof] == Approx(extrema[dof].max).margin(1e-9) );
+            }
+        }
+    }
+
+    SECTION("Polynomial roots") {
+        // Nearly linear poly, e.g. of a segment with a rounding error in the acceleration
+        const std::array<double, 4> linear {0.0, DBL_EPSILON, 0.14559315310760956, -0.68346329628283953};
+        auto roots = Roots::solveCub(linear[0], linear[1], linear[2], linear[3]);
+        REQUIRE( roots.size() == 2 );
+        CHECK( std::any_of(roots.begin(), roots.end(), [](double t) { return std::abs(t - 4.6943) < 1e-4; }) );
+
+        // Polishing stays within the bracket and keeps an exact root
+        const std::array<double, 5> quartic {1.0, -10.0, 35.0, -50.0, 24.0}; // Roots 1, 2, 3, 4
+        CHECK( Roots::polishRoot(quartic, 2.0 + 1e-7) == Approx(2.0).epsilon(1e-14) );
+        CHECK( Roots::polishRoot(quartic, 3.0) == 3.0 );
+        CHECK( Roots::polishRoot(quartic, 2.5) == 2.5 );
+    }
+
+    SECTION("Time at position with 3 DoF") {
+        Ruckig<3> otg {0.005};
+        RuckigTrajectory<3> trajectory;
+        InputParameter<3> input;
+        Vec new_position, new_velocity, new_acceleration;
+        double time;
+
+        srand(54);
+        std::default_random_engine gen;
+        std::uniform_real_distribution<double> dist(0.0, 1.0);
+
+        for (size_t i = 0; i < 256; i += 1) {
+            random_input(input, 0.1, 1.0);
+            input.target_velocity = input.max_velocity.cwiseProduct(Vec::Random());
+
+            REQUIRE( otg.calculate(input, trajectory) == Result::Working );
+            const double duration = trajectory.get_duration();
+            const auto extrema = trajectory.get_position_extrema();
+
+            // A position passed at a random time
+            const double t_passed = dist(gen) * duration;
+            trajectory.at_time(t_passed, new_position, new_velocity, new_acceleration);
+            const Vec positions = new_position;
+
+            for (size_t dof = 0; dof < 3; dof += 1) {
+                REQUIRE( trajectory.get_first_time_at_position(dof, positions[dof], time) );
+                CHECK( time <= t_passed + 1e-9 );
+
+                trajectory.at_time(time, new_position, new_velocity, new_acceleration);
+                CHECK( new_position[dof] == Approx(positions[dof]).margin(1e-9) );
+
+                // The position isn't passed earlier
+                const double side = input.current_position[dof] - positions[dof];
+                for (size_t step = 0; step < 100; step += 1) {
+                    trajectory.at_time(0.99 * step * time / 100, new_position, new_velocity, new_acceleration);
+                    CHECK( (new_position[dof] - positions[dof]) * side >= 0.0 );
+                }
+
+                CHECK( trajectory.get_first_time_at_position(dof, input.current_position[dof], time) );
+                CHECK( time == 0.0 );
+                CHECK( trajectory.get_first_time_at_position(dof, input.target_position[dof], time) );
+                CHECK_FALSE( trajectory.get_first_time_at_position(dof, extrema[dof].max + 1.0, time) );
+            }
+        }
+    }
+
+    SECTION("Bulk sampling with 3 DoF") {
+        Ruckig<3> otg {0.005};
+        RuckigTrajectory<3> trajectory;
+        InputParameter<3> input;
+        Vec new_position, new_velocity, new_acceleration;
+
+        constexpr size_t n {257};
+        Eigen::MatrixXd positions(n, 3), velocities(n, 3), accelerations(n, 3);
+
+        srand(55);
+
+        for (size_t i = 0; i < 256; i += 1) {
+            random_input(input, 0.1, 1.2);
+            input.target_velocity = input.max_velocity.cwiseProduct(Vec::Random());
+            input.enabled = {true, i % 4 != 0, true};
+
+            REQUIRE( otg.calculate(input, trajectory) == Result::Working );
+
+            // Until after the end of the trajectory
+            const double t0 = 0.0;
+            const double dt = 1.1 * trajectory.get_duration() / (n - 1);
+            trajectory.sample(t0, dt, positions, velocities, accelerations);
+
+            for (size_t s = 0; s < n; s += 1) {
+                trajectory.at_time(t0 + s * dt, new_position, new_velocity, new_acceleration);
+                for (size_t dof = 0; dof < 3; dof += 1) {
+                    CHECK( positions(s, dof) == Approx(new_position[dof]).margin(1e-9) );
+                    CHECK( velocities(s, dof) == Approx(new_velocity[dof]).margin(1e-9) );
+                    CHECK( accelerations(s, dof) == Approx(new_acceleration[dof]).margin(1e-9) );
+                }
+            }
+        }
+    }
+
+    SECTION("Discrete duration with 3 DoF") {
+        constexpr double delta_time {0.005};
+        Ruckig<3> otg {delta_time};
+        InputParameter<3> input;
+        OutputParameter<3> output;
+        input.duration_discretization = InputParameter<3>::DurationDiscretization::Discrete;
+
+        srand(56);
+
+        for (size_t i = 0; i < 256; i += 1) {
+            random_input(input, 0.1, 1.0);
+            input.target_velocity = input.max_velocity.cwiseProduct(Vec::Random());
+            input.synchronization = (i % 2 == 0) ? InputParameter<3>::Synchronization::Time : InputParameter<3>::Synchronization::Phase;
+            if (i % 8 == 1) {
+                // Collinear input for the phase synchronization
+                input.current_velocity.setZero();
+                input.current_acceleration.setZero();
+                input.target_velocity.setZero();
+            }
+
+            const InputParameter<3> initial_input = input;
+            input.mark_changed();
+
+            // The duration is a multiple of the control cycle
+            REQUIRE( otg.update(input, output) == Result::Working );
+            const double cycles = output.duration / delta_time;
+            CHECK( cycles == Approx(std::round(cycles)).margin(1e-6) );
+
+            // The last working step is exactly one cycle before the duration, so that the final step doesn't jump to the target
+            size_t steps {1};
+            Result result;
+            while ((result = otg.update(input, output)) == Result::Working) {
+                input.current_position = output.new_position;
+                input.current_velocity = output.new_velocity;
+                input.current_acceleration = output.new_acceleration;
+                steps += 1;
+            }
+            CHECK( result == Result::Finished );
+            CHECK( steps == std::max<size_t>(std::round(cycles), 1) );
+
+            Vec new_position, new_velocity, new_acceleration;
+            otg.get_trajectory().at_time(output.duration, new_position, new_velocity, new_acceleration);
+            CHECK( (new_position - initial_input.target_position).norm() < 1e-6 );
+            CHECK( (new_velocity - initial_input.target_velocity).norm() < 1e-6 );
+        }
+    }
+
+    SECTION("Precomputed segments with 3 DoF") {
+        Ruckig<3> otg {0.005};
+        RuckigTrajectory<3> trajectory;
+        InputParameter<3> input;
+        Vec new_position, new_velocity, new_acceleration;
+        double p, v, a;
+
+        srand(57);
+
+        for (size_t i = 0; i < 256; i += 1) {
+            random_input(input, 0.1, 1.2);
+            input.target_velocity = input.max_velocity.cwiseProduct(Vec::Random());
+            input.enabled = {true, i % 4 != 0, true};
+
+            if (otg.calculate(input, trajectory) != Result::Working) {
+                continue;
+            }
+
+            // Same as integrating the profiles, until after the end of the trajectory
+            const double duration = trajectory.get_duration();
+            for (size_t step = 0; step <= 100; step += 1) {
+                const double time = 1.1 * step * duration / 100;
+                trajectory.at_time(time, new_position, new_velocity, new_acceleration);
+                for (size_t dof = 0; dof < 3; dof += 1) {
+                    if (!trajectory.is_enabled(dof)) {
+                        CHECK( new_position[dof] == input.current_position[dof] );
+                        continue;
+                    }
+
+                    trajectory.get_profile(dof).state_at_time(time, p, v, a);
+                    CHECK( new_position[dof] == Approx(p).margin(1e-9) );
+                    CHECK( new_velocity[dof] == Approx(v).margin(1e-9) );
+                    CHECK( new_acceleration[dof] == Approx(a).margin(1e-9) );
+                }
+            }
+        }
+    }
+
+    SECTION("Stop with 3 DoF") {
+        Ruckig<3> otg {0.005};
+        Ruckig<1> otg_single {0.005};
+        RuckigTrajectory<3> trajectory, trajectory_stop;
+        RuckigTrajectory<1> trajectory_single;
+        InputParameter<3> input;
+        InputParameter<1> input_single;
+        Vec new_position, new_velocity, new_acceleration;
+
+        srand(58);
+
+        for (size_t i = 0; i < 1024; i += 1) {
+            random_input(input, 0.1, 1.2);
+            input.set_stop();
+
+            REQUIRE( otg.calculate(input, trajectory) == Result::Working );
+
+            // Standstill at the end of the trajectory
+            const double duration = trajectory.get_duration();
+            trajectory.at_time(duration, new_position, new_velocity, new_acceleration);
+            CHECK( new_velocity.norm() < 1e-8 );
+            CHECK( new_acceleration.norm() < 1e-8 );
+
+            // Each DoF stops as fast as possible on its own
+            input_single.set_stop();
+            for (size_t dof = 0; dof < 3; dof += 1) {
+                input_single.current_position[0] = input.current_position[dof];
+                input_single.current_velocity[0] = input.current_velocity[dof];
+                input_single.current_acceleration[0] = input.current_acceleration[dof];
+                input_single.max_acceleration[0] = input.max_acceleration[dof];
+                input_single.max_jerk[0] = input.max_jerk[dof];
+
+                REQUIRE( otg_single.calculate(input_single, trajectory_single) == Result::Working );
+                CHECK( trajectory.get_profile(dof).duration() == Approx(trajectory_single.get_duration()).margin(1e-12) );
+            }
+            CHECK( duration == Approx(std::max({trajectory.get_profile(0).duration(), trajectory.get_profile(1).duration(), trajectory.get_profile(2).duration()})) );
+
+            // The closed-form stop ignores the targets of the input
+            input.type = InputParameter<3>::Type::Position;
+            input.target_position = Vec::Random();
+            input.synchronization = InputParameter<3>::Synchronization::Phase;
+            REQUIRE( otg.calculate_stop(input, trajectory_stop) == Result::Working );
+            CHECK( trajectory_stop.get_duration() == Approx(duration).margin(1e-12) );
+            trajectory_stop.at_time(duration, new_position, new_velocity, new_acceleration);
+            CHECK( new_velocity.norm() < 1e-8 );
+            CHECK( new_acceleration.norm() < 1e-8 );
+        }
+
+        // A phase-synchronized stop of a collinear motion stays on its line
+        for (size_t i = 0; i < 256; i += 1) {
+            const Vec direction = Vec::Random();
+            random_input(input);
+            input.current_velocity = Vec::Random()[0] * direction;
+            input.current_acceleration = Vec::Random()[0] * direction;
+            input.set_stop(InputParameter<3>::Synchronization::Phase);
+
+            REQUIRE( otg.calculate(input, trajectory) == Result::Working );
+            const double duration = trajectory.get_duration();
+            for (double t = 0.0; t < duration; t += duration / 64) {
+                trajectory.at_time(t, new_position, new_velocity, new_acceleration);
+                const Vec offset = new_position - input.current_position;
+                CHECK( (offset - offset.dot(direction) / direction.squaredNorm() * direction).norm() < 1e-8 );
+                CHECK( (new_acceleration.cwiseAbs().array() <= input.max_acceleration.array().max(input.current_acceleration.cwiseAbs().array()) + 1e-8).all() );
+            }
+
+            trajectory.at_time(duration, new_position, new_velocity, new_acceleration);
+            CHECK( new_velocity.norm() < 1e-8 );
+            CHECK( new_acceleration.norm() < 1e-8 );
+        }
+    }
+
+    SECTION("Worker pool with 24 DoF") {
+        constexpr size_t dofs {24};
+        using VecN = InputParameter<0>::Vector;
+
+        Ruckig<0> otg {dofs, 0.005};
+        Ruckig<0> otg_parallel {dofs, 0.005};
+        otg_parallel.worker_pool = std::make_shared<WorkerPool>(3);
+        RuckigTrajectory<0> trajectory {dofs}, trajectory_parallel {dofs};
+        InputParameter<0> input {dofs};
+
+        srand(60);
+
+        for (size_t i = 0; i < 1024; i += 1) {
+            random_input(input);
+            input.target_velocity = (i % 2 == 0) ? (VecN)VecN::Zero(dofs) : (VecN)(0.5 * input.max_velocity.cwiseProduct(VecN::Random(dofs)));
+            input.type = (i % 4 == 3) ? InputParameter<0>::Type::Velocity : InputParameter<0>::Type::Position;
+
+            // Same result and error as the serial calculation
+            const Result result = otg.calculate(input, trajectory);
+            REQUIRE( otg_parallel.calculate(input, trajectory_parallel) == result );
+            if (result != Result::Working) {
+                CHECK( otg_parallel.get_error().dof == otg.get_error().dof );
+                continue;
+            }
+
+            CHECK( trajectory_parallel.get_duration() == trajectory.get_duration() );
+            for (size_t dof = 0; dof < dofs; dof += 1) {
+                CHECK( trajectory_parallel.get_profile(dof).t == trajectory.get_profile(dof).t );
+            }
+        }
+    }
+
+    SECTION("Worker pool loops") {
+        WorkerPool pool {3};
+
+        // A loop from within a loop runs serially in the calling thread
+        std::vector<std::atomic<size_t>> calls(64 * 64);
+        pool.for_each(64, [&](size_t i) {
+            pool.for_each(64, [&](size_t j) {
+                calls[64 * i + j] += 1;
+                return true;
+            });
+            return true;
+        });
+        CHECK( std::all_of(calls.begin(), calls.end(), [](const std::atomic<size_t>& c) { return c == 1; }) );
+
+        // All iterations before a cancelling one are run
+        for (size_t k = 0; k < 256; k += 1) {
+            std::vector<std::atomic<size_t>> cancelled_calls(64);
+            pool.for_each(64, [&](size_t i) {
+                cancelled_calls[i] += 1;
+                return i != 20;
+            });
+            CHECK( std::all_of(cancelled_calls.begin(), cancelled_calls.begin() + 21, [](const std::atomic<size_t>& c) { return c == 1; }) );
+        }
+
+        // Each thread is initialized once, e.g. for its priority
+        std::atomic<size_t> initialized_threads {0};
+        {
+            WorkerPool pool_initialized {3, [&](size_t index) { initialized_threads |= (1 << index); }};
+        }
+        CHECK( initialized_threads == 0b111 );
+    }
+
+    SECTION("Computation budget with 3 DoF") {
+        Ruckig<3> otg {0.005};
+        InputParameter<3> input;
+        OutputParameter<3> output;
+        Vec new_position, new_velocity, new_acceleration;
+
+        input.current_position = {0.0, -1.0, 0.5};
+        input.current_velocity = {1.0, 0.5, -0.5};
+        input.target_position = {1.0, 1.0, -0.5};
+        input.max_velocity = {1.0, 2.0, 1.0};
+        input.max_acceleration = {2.0, 1.0, 1.0};
+        input.max_jerk = {4.0, 3.0, 2.0};
+
+        // Without a previous trajectory, brake while retrying
+        otg.calculation_budget = 0.0;
+        for (size_t i = 0; i < 10; i += 1) {
+            CHECK( otg.update(input, output) == Result::Working );
+            CHECK( otg.get_error().result == Result::ErrorCalculationTimeout );
+            CHECK( std::abs(output.new_velocity[0]) <= std::abs(input.current_velocity[0]) );
+            output.pass_to_input(input);
+        }
+        CHECK( std::abs(input.current_velocity[0]) < 1.0 );
+
+        otg.calculation_budget = 1e6;
+        CHECK( otg.update(input, output) == Result::Working );
+        const RuckigTrajectory<3> trajectory = otg.get_trajectory();
+        output.pass_to_input(input);
+
+        // Keep following the previous trajectory while retrying
+        otg.calculation_budget = 0.0;
+        input.target_position = {-1.0, 0.0, 1.0};
+        for (size_t i = 0; i < 10; i += 1) {
+            CHECK( otg.update(input, output) == Result::Working );
+            trajectory.at_time(0.005 * (i + 1), new_position, new_velocity, new_acceleration);
+            CHECK( (output.new_position - new_position).norm() < 1e-12 );
+            CHECK( (output.new_velocity - new_velocity).norm() < 1e-12 );
+            output.pass_to_input(input);
+        }
+
+        // Errors other than a timeout are returned immediately
+        otg.calculation_budget = 1e6;
+        InputParameter<3> input_invalid = input;
+        input_invalid.max_jerk = {4.0, -3.0, 2.0};
+        CHECK( otg.update(input_invalid, output) == Result::ErrorInvalidInput );
+        CHECK( otg.update(input_invalid, output) == Result::ErrorInvalidInput );
+        CHECK( otg.get_error().result == Result::ErrorInvalidInput );
+
+        otg.calculation_budget.reset();
+        while (otg.update(input, output) == Result::Working) {
+            output.pass_to_input(input);
+        }
+        CHECK( output.new_position == input.target_position );
+    }
+
 #ifdef WITH_REFLEXXES
     SECTION("Comparison with Reflexxes with 1 DoF") {
         Ruckig<1> otg {0.005};
@@ -224,26 +1230,26 @@ TEST_CASE("Ruckig") {
         std::uniform_real_distribution<double> dist(0.0, 1.0);
 
         for (size_t i = 0; i < 32*1024; i += 1) {
-            input.current_position = Vec1::Random();
-            input.current_velocity = dist(gen) < 0.9 ? (Vec1)Vec1::Random() : (Vec1)Vec1::Zero();
-            input.current_acceleration = dist(gen) < 0.85 ? (Vec1)Vec1::Random() : (Vec1)Vec1::Zero();
-            input.target_position = Vec1::Random();
-            input.max_velocity = 10 * Vec1::Random().array().abs() + 0.1;
-            input.max_acceleration = 10 * Vec1::Random().array().abs() + 0.1;
-            input.max_jerk = 10 * Vec1::Random().array().abs() + 0.1;
+            random_input(input);
+            if (dist(gen) >= 0.9) {
+                input.current_velocity.setZero();
+            }
+            if (dist(gen) >= 0.85) {
+                input.current_acceleration.setZero();
+            }
 
             check_comparison(otg, input, rflx);
         }
 
         for (size_t i = 0; i < 128; i += 1) {
-            input.current_position = Vec1::Random();
-            input.current_velocity = dist(gen) < 0.9 ? (Vec1)Vec1::Random() : (Vec1)Vec1::Zero();
-            input.current_acceleration = dist(gen) < 0.8 ? (Vec1)Vec1::Random() : (Vec1)Vec1::Zero();
-            input.target_position = Vec1::Random();
-            input.target_velocity = Vec1::Random();
-            input.max_velocity = 10 * Vec1::Random().array().abs() + input.target_velocity.array().abs(); // Target velocity needs to be smaller than max velocity
-            input.max_acceleration = 10 * Vec1::Random().array().abs() + 0.1;
-            input.max_jerk = 10 * Vec1::Random().array().abs() + 0.1;
+            random_input(input);
+            if (dist(gen) >= 0.9) {
+                input.current_velocity.setZero();
+            }
+            if (dist(gen) >= 0.8) {
+                input.current_acceleration.setZero();
+            }
+            input.target_velocity = input.max_velocity.cwiseProduct(Vec1::Random()); // Target velocity needs to be smaller than max velocity
 
             check_comparison(otg, input, rflx);
         }
@@ -259,13 +1265,13 @@ TEST_CASE("Ruckig") {
         std::uniform_real_distribution<double> dist(0.0, 1.0);
 
         for (size_t i = 0; i < 0; i += 1) {
-            input.current_position = Vec2::Random();
-            input.current_velocity = dist(gen) < 0.9 ? (Vec2)Vec2::Random() : (Vec2)Vec2::Zero();
-            input.current_acceleration = dist(gen) < 0.8 ? (Vec2)Vec2::Random() : (Vec2)Vec2::Zero();
-            input.target_position = Vec2::Random();
-            input.max_velocity = 10 * Vec2::Random().array().abs() + 0.1;
-            input.max_acceleration = 10 * Vec2::Random().array().abs() + 0.1;
-            input.max_jerk = 10 * Vec2::Random().array().abs() + 0.1;
+            random_input(input);
+            if (dist(gen) >= 0.9) {
+                input.current_velocity.setZero();
+            }
+            if (dist(gen) >= 0.8) {
+                input.current_acceleration.setZero();
+            }
 
             check_comparison(otg, input, rflx);
         }
@@ -281,13 +1287,13 @@ TEST_CASE("Ruckig") {
         std::uniform_real_distribution<double> dist(0.0, 1.0);
 
         for (size_t i = 0; i < 32*1024; i += 1) {
-            input.current_position = Vec::Random();
-            input.current_velocity = dist(gen) < 0.9 ? (Vec)Vec::Random() : (Vec)Vec::Zero();
-            input.current_acceleration = dist(gen) < 0.8 ? (Vec)Vec::Random() : (Vec)Vec::Zero();
-            input.target_position = Vec::Random();
-            input.max_velocity = 10 * Vec::Random().array().abs() + 0.1;
-            input.max_acceleration = 10 * Vec::Random().array().abs() + 0.1;
-            input.max_jerk = 10 * Vec::Random().array().abs() + 0.1;
+            random_input(input);
+            if (dist(gen) >= 0.9) {
+                input.current_velocity.setZero();
+            }
+            if (dist(gen) >= 0.8) {
+                input.current_acceleration.setZero();
+            }
 
             check_comparison(otg, input, rflx);
         }
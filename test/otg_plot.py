@@ -10,7 +10,7 @@ from _movex import Quintic, InputParameter, OutputParameter, Result, Ruckig, Smo
 def walk_through_trajectory(otg, inp):
     t = 0.0
     t_list, out_list = [], []
-    out = OutputParameter()
+    out = OutputParameter(inp.degrees_of_freedom)
 
     res = Result.Working
     while res == Result.Working:
@@ -90,7 +90,7 @@ jMax->{inp.max_jerk[dof]}"""
 
 
 if __name__ == '__main__':
-    inp = InputParameter()
+    inp = InputParameter(2)
     inp.current_position = [-0.160382, -0.53]
     inp.current_velocity = [-0.615, 0.558]
     inp.current_acceleration = [-0.5706, 0.887]
@@ -104,10 +104,10 @@ if __name__ == '__main__':
 
     print_input_for_mathematica(inp, 0, tf=22.761)
 
-    # otg = Quintic(0.005)
-    # otg = Smoothie(0.005)
-    # otg = Reflexxes(0.005)
-    otg = Ruckig(0.005)
+    # otg = Quintic(inp.degrees_of_freedom, 0.005)
+    # otg = Smoothie(inp.degrees_of_freedom, 0.005)
+    # otg = Reflexxes(inp.degrees_of_freedom, 0.005)
+    otg = Ruckig(inp.degrees_of_freedom, 0.005)
 
     t_list, out_list = walk_through_trajectory(otg, inp)
 